@@ -0,0 +1,473 @@
+/*
+ * Adaptive Lookup Benchmarks
+ * ==========================
+ *
+ * bench_strcmp.c always looks for the needle at the very end. Real queries
+ * are skewed, a few keys get most of the lookups. Quick bench to see if
+ * letting the structure adapt to the queries pays off.
+ *
+ * - Static strcmp scan (like bench_strcmp)
+ * - Static hash ahead of time scan (like bench_hash_at)
+ * - Move to front, a hit is moved to the front of the scan list
+ * - Transpose, a hit is swapped with the one before it
+ * - Hot key cache, small direct mapped cache keyed by hash in front of the
+ *   hash ahead of time scan
+ * - Queries follow a Zipf distribution, hottest key is random so it
+ *   doesn't start at the front
+ * - Using RTDSC timer, cycles per lookup
+ * - Runs through harness.h, printed numbers are the best sample
+ * - -DBENCH_LATENCY records each lookup into a histogram, see harness.h
+ *
+ * Scans report the average number of entries looked at per lookup, the
+ * cache reports its hit rate.
+ *
+ * Platforms
+ * ---------
+ *
+ * 1.
+ * Linux Debian 12 - Intel(R) Xeon(R) Processor
+ * gcc bench_adaptive.c -DBENCH_TO_RUN=BENCH_<TEST> -O3 -lm (GCC 12.2.0)
+ *
+ * Results
+ * -------
+ *
+ * _Note:_ 1024 keys, 100k lookups
+ * _Note:_ Cycles per lookup, brackets are entries scanned or cache hit %
+ *
+ *  Platform | Zipf | strcmp     | hash at   | move to front | transpose  | hot cache
+ * ==========|======|============|===========|===============|============|============
+ *  1(GCC)   | 0.5  | 7348(511)  | 898(511)  | 6214(416)     | 7812(474)  | 1515(11%)
+ *  1(GCC)   | 1.0  | 10642(496) | 871(496)  | 2867(185)     | 4642(275)  | 1096(41%)
+ *  1(GCC)   | 1.5  | 6984(528)  | 919(528)  | 674(36)       | 1691(105)  | 627(66%)
+ *
+ */
+
+#define BENCH_STRCMP 1
+#define BENCH_HASH_AT 2
+#define BENCH_MOVE_TO_FRONT 3
+#define BENCH_TRANSPOSE 4
+#define BENCH_HOT_CACHE 5
+
+
+#ifndef BENCH_TO_RUN
+#define BENCH_TO_RUN BENCH_STRCMP
+#endif
+
+/* number of distinct keys */
+#ifndef BENCH_KEYS
+#define BENCH_KEYS 1024
+#endif
+
+/* lookups per skew */
+#ifndef BENCH_LOOKUPS
+#define BENCH_LOOKUPS 100000
+#endif
+
+/* entries in the hot key cache, power of 2 */
+#ifndef BENCH_CACHE_SIZE
+#define BENCH_CACHE_SIZE 64
+#endif
+
+/* each run is every lookup for a skew, so fewer than the harness default */
+#ifndef BENCH_SAMPLES
+#define BENCH_SAMPLES 5
+#endif
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <x86intrin.h>
+
+#include "harness.h"
+
+/* same words as bench_strcmp.c, generated keys fill up to BENCH_KEYS */
+const char *strings[] = {
+        "a", "b", "c", "1", "2", "3", "abc", "123",
+        "if", "else if", "else", "break", "continue", "for", "while", "do",
+        "goto", "struct", "int", "float", "unsigned", "double", "char", "const",
+        "cpu", "gpu", "memory", "keyboard", "screen", "mouse", "template",
+        "compiler", "type", "class", "jaffa cake", "then", "reduce", "reuse",
+        "recycle", "black cats", "kiteboard", "surfboard", "skateboard",
+        "wakeboard", "wobbleboard", "breadboard",
+        "A really long string that takes up space",
+        "This is also a longer string that takes up space, time, and sugar",
+        "Everybody jump jump! Everybody jump jump jump jump jump jump!",
+        "Flowers with purple spots, bannanas and apples",
+        "The Quick Brown Fox Jumped Over The Lazy Dog",
+        "Lorim Ipsum",
+        "Foo", "Bar", "Baz", "Bin", "Fin", "Fab", "Boo", "Far", "FooBar",
+        "FooBoo", "BarBar", "Faz", "FinFar", "FabFin", "BazBoo", "BarFoo",
+        "needle",
+        NULL
+};
+
+double skews[] = { 0.5, 0.75, 1.0, 1.25, 1.5 };
+
+uint64_t
+hash_str(const char *str) {
+        uint64_t hash = 5381;
+        int c;
+        while(c = *str++, c) {
+          hash = ((hash << 5) + hash) + c;
+        }
+
+        return hash;
+}
+
+
+/* xorshift, same sequence every run */
+uint64_t rand_state = 0x2545F4914F6CDD1Dull;
+
+uint64_t
+rand_next() {
+        rand_state ^= rand_state << 13;
+        rand_state ^= rand_state >> 7;
+        rand_state ^= rand_state << 17;
+        return rand_state;
+}
+
+
+/* keys and queries */
+const char *keys[BENCH_KEYS];
+uint64_t key_hashes[BENCH_KEYS];
+
+/* each query is an index into keys, the string is a separate copy so
+   strcmp can't shortcut on pointer equality */
+const char *queries[BENCH_LOOKUPS];
+uint64_t query_hashes[BENCH_LOOKUPS];
+
+void
+build_keys() {
+        uint64_t word_count = 0;
+        int i;
+        char buf[64];
+
+        while(strings[word_count]) {
+                ++word_count;
+        }
+
+        for(i = 0; i < BENCH_KEYS; ++i) {
+                if(i < (int)word_count) {
+                        keys[i] = strdup(strings[i]);
+                } else {
+                        snprintf(buf, sizeof(buf), "%s %d",
+                                strings[i % word_count], i);
+                        keys[i] = strdup(buf);
+                }
+                key_hashes[i] = hash_str(keys[i]);
+        }
+}
+
+
+/* Zipf, key of rank r gets weight 1 / r^s. Ranks are shuffled onto keys. */
+void
+build_queries(double s) {
+        static double cdf[BENCH_KEYS];
+        static int rank_to_key[BENCH_KEYS];
+        static const char *copies[BENCH_KEYS];
+        double total = 0.0;
+        int i;
+
+        for(i = 0; i < BENCH_KEYS; ++i) {
+                rank_to_key[i] = i;
+                if(!copies[i]) {
+                        copies[i] = strdup(keys[i]);
+                }
+        }
+
+        for(i = BENCH_KEYS - 1; i > 0; --i) {
+                int j = (int)(rand_next() % (i + 1));
+                int tmp = rank_to_key[i];
+                rank_to_key[i] = rank_to_key[j];
+                rank_to_key[j] = tmp;
+        }
+
+        for(i = 0; i < BENCH_KEYS; ++i) {
+                total += 1.0 / pow((double)(i + 1), s);
+                cdf[i] = total;
+        }
+
+        for(i = 0; i < BENCH_LOOKUPS; ++i) {
+                double u = (double)(rand_next() >> 11) / 9007199254740992.0;
+                double target = u * total;
+                int lo = 0, hi = BENCH_KEYS - 1;
+
+                while(lo < hi) {
+                        int mid = (lo + hi) / 2;
+                        if(cdf[mid] < target) {
+                                lo = mid + 1;
+                        } else {
+                                hi = mid;
+                        }
+                }
+
+                int key = rank_to_key[lo];
+                queries[i] = copies[key];
+                query_hashes[i] = key_hashes[key];
+        }
+}
+
+
+/* how many keys were found and how many entries scanned / cache hits */
+uint64_t found_count = 0;
+uint64_t probe_count = 0;
+uint64_t hit_count = 0;
+
+
+/* static strcmp scan */
+uint64_t
+bench_strcmp() {
+        uint64_t found = 0;
+        uint64_t probes = 0;
+        int i, j;
+        uint64_t start = harness_start();
+
+        for(i = 0; i < BENCH_LOOKUPS; ++i, HARNESS_OP()) {
+                for(j = 0; j < BENCH_KEYS; ++j) {
+                        if(strcmp(keys[j], queries[i]) == 0) {
+                                found += 1;
+                                break;
+                        }
+                }
+                probes += j + 1;
+        }
+
+        uint64_t end = harness_stop();
+
+        found_count = found;
+        probe_count = probes;
+
+        return end - start;
+}
+
+
+/* static hash ahead of time scan */
+uint64_t
+bench_hash_at() {
+        uint64_t found = 0;
+        uint64_t probes = 0;
+        int i, j;
+        uint64_t start = harness_start();
+
+        for(i = 0; i < BENCH_LOOKUPS; ++i, HARNESS_OP()) {
+                uint64_t hash = query_hashes[i];
+                for(j = 0; j < BENCH_KEYS; ++j) {
+                        if(key_hashes[j] == hash) {
+                                found += 1;
+                                break;
+                        }
+                }
+                probes += j + 1;
+        }
+
+        uint64_t end = harness_stop();
+
+        found_count = found;
+        probe_count = probes;
+
+        return end - start;
+}
+
+
+/* move to front, list is a copy so each skew starts from the same order */
+uint64_t
+bench_move_to_front() {
+        const char *list[BENCH_KEYS];
+        uint64_t found = 0;
+        uint64_t probes = 0;
+        int i, j;
+
+        memcpy(list, keys, sizeof(list));
+
+        uint64_t start = harness_start();
+
+        for(i = 0; i < BENCH_LOOKUPS; ++i, HARNESS_OP()) {
+                for(j = 0; j < BENCH_KEYS; ++j) {
+                        if(strcmp(list[j], queries[i]) == 0) {
+                                const char *hit = list[j];
+                                memmove(&list[1], &list[0],
+                                        j * sizeof(list[0]));
+                                list[0] = hit;
+                                found += 1;
+                                break;
+                        }
+                }
+                probes += j + 1;
+        }
+
+        uint64_t end = harness_stop();
+
+        found_count = found;
+        probe_count = probes;
+
+        return end - start;
+}
+
+
+/* transpose, a hit moves one step towards the front */
+uint64_t
+bench_transpose() {
+        const char *list[BENCH_KEYS];
+        uint64_t found = 0;
+        uint64_t probes = 0;
+        int i, j;
+
+        memcpy(list, keys, sizeof(list));
+
+        uint64_t start = harness_start();
+
+        for(i = 0; i < BENCH_LOOKUPS; ++i, HARNESS_OP()) {
+                for(j = 0; j < BENCH_KEYS; ++j) {
+                        if(strcmp(list[j], queries[i]) == 0) {
+                                if(j > 0) {
+                                        const char *tmp = list[j - 1];
+                                        list[j - 1] = list[j];
+                                        list[j] = tmp;
+                                }
+                                found += 1;
+                                break;
+                        }
+                }
+                probes += j + 1;
+        }
+
+        uint64_t end = harness_stop();
+
+        found_count = found;
+        probe_count = probes;
+
+        return end - start;
+}
+
+
+/* hot key cache, direct mapped on the low hash bits, holds the index of the
+   last key seen in that slot. Misses fall through to the hash at scan. */
+struct cache_entry {
+        uint64_t hash;
+        int64_t index;
+};
+
+uint64_t
+bench_hot_cache() {
+        struct cache_entry cache[BENCH_CACHE_SIZE];
+        uint64_t found = 0;
+        uint64_t probes = 0;
+        uint64_t hits = 0;
+        int i, j;
+
+        for(i = 0; i < BENCH_CACHE_SIZE; ++i) {
+                cache[i].hash = 0;
+                cache[i].index = -1;
+        }
+
+        uint64_t start = harness_start();
+
+        for(i = 0; i < BENCH_LOOKUPS; ++i, HARNESS_OP()) {
+                uint64_t hash = query_hashes[i];
+                struct cache_entry *entry =
+                        &cache[hash & (BENCH_CACHE_SIZE - 1)];
+
+                if(entry->index >= 0 && entry->hash == hash) {
+                        hits += 1;
+                        found += 1;
+                        continue;
+                }
+
+                for(j = 0; j < BENCH_KEYS; ++j) {
+                        if(key_hashes[j] == hash) {
+                                entry->hash = hash;
+                                entry->index = j;
+                                found += 1;
+                                break;
+                        }
+                }
+                probes += j + 1;
+        }
+
+        uint64_t end = harness_stop();
+
+        found_count = found;
+        probe_count = probes;
+        hit_count = hits;
+
+        return end - start;
+}
+
+
+/* Benchmark */
+int
+main() {
+        uint64_t (*bench)() = 0;
+        const char *name = "";
+        int s, i;
+
+        if(BENCH_TO_RUN == BENCH_STRCMP) {
+                bench = bench_strcmp;
+                name = "strcmp";
+        }
+
+        if(BENCH_TO_RUN == BENCH_HASH_AT) {
+                bench = bench_hash_at;
+                name = "hash at";
+        }
+
+        if(BENCH_TO_RUN == BENCH_MOVE_TO_FRONT) {
+                bench = bench_move_to_front;
+                name = "move to front";
+        }
+
+        if(BENCH_TO_RUN == BENCH_TRANSPOSE) {
+                bench = bench_transpose;
+                name = "transpose";
+        }
+
+        if(BENCH_TO_RUN == BENCH_HOT_CACHE) {
+                bench = bench_hot_cache;
+                name = "hot cache";
+        }
+
+        build_keys();
+
+        for(s = 0; s < (int)(sizeof(skews) / sizeof(skews[0])); ++s) {
+                struct harness cycles;
+                struct harness scanned;
+                struct harness hits;
+                char inputs[64];
+
+                snprintf(inputs, sizeof(inputs), "zipf %.2f", skews[s]);
+                build_queries(skews[s]);
+
+                harness_begin(&cycles, "adaptive", name, inputs,
+                        "cycles/lookup", 1);
+                harness_begin(&scanned, "adaptive", name, inputs,
+                        "scanned/lookup", 1);
+                harness_begin(&hits, "adaptive", name, inputs, "hit %", 0);
+
+                for(i = 0; i < BENCH_SAMPLES; ++i) {
+                        found_count = probe_count = hit_count = 0;
+                        harness_sample(&cycles,
+                                (double)bench() / BENCH_LOOKUPS);
+                        harness_sample(&scanned,
+                                (double)probe_count / BENCH_LOOKUPS);
+                        harness_sample(&hits,
+                                100.0 * hit_count / BENCH_LOOKUPS);
+                }
+
+                harness_report(&cycles);
+                harness_report(&scanned);
+                if(BENCH_TO_RUN == BENCH_HOT_CACHE) {
+                        harness_report(&hits);
+                        printf("Hit rate: %.1f%%\n", hits.max);
+                }
+
+                printf("Found: %llu\n", (unsigned long long)found_count);
+                printf("Scanned per lookup: %.1f\n", scanned.min);
+                printf("Zipf %.2f %s: %.1f cycles per lookup\n--\n",
+                        skews[s], name, cycles.min);
+        }
+
+        return 0;
+}
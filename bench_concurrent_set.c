@@ -0,0 +1,648 @@
+/*
+ * Concurrent String Set Benchmarks
+ * ================================
+ *
+ * Lots of reader threads and the odd insert. Open addressing set of
+ * strings keyed by a precomputed hash_str (like bench_hash_at in
+ * bench_strcmp.c), readers never take a lock.
+ *
+ * - Lock free readers, epoch based reclamation of old tables on resize
+ * - pthread rwlock around the same table
+ * - pthread mutex around the same table
+ * - Write percent is the share of each thread's ops that are inserts
+ * - Throughput is lookups/sec over all threads, from the monotonic clock
+ * - Runs through harness.h, printed throughput is the best sample
+ *
+ * Readers announce the epoch they entered in and the table they load is
+ * only freed once every reader has left or moved on to a newer epoch.
+ * Load factor is kept under 1/2 so a probe always hits an empty slot,
+ * which bounds lookups by the table size.
+ *
+ * gcc bench_concurrent_set.c -DBENCH_TO_RUN=BENCH_<TEST> -O3 -pthread
+ *
+ * Platforms
+ * ---------
+ *
+ * 1.
+ * Linux Debian 12 - Intel(R) Xeon(R) Processor (1 core)
+ * gcc bench_concurrent_set.c -DBENCH_TO_RUN=BENCH_<TEST> -O3 -pthread (GCC 12.2.0)
+ *
+ * Results
+ * -------
+ *
+ * _Note:_ Millions of lookups/sec, 4 threads
+ * _Note:_ Platform 1 has a single core so doesn't show scaling
+ *
+ *  Platform | Writes | Lock free | rwlock | mutex
+ * ==========|========|===========|========|=======
+ *  1(GCC)   | 0%     | 20.9      | 19.8   | 22.1
+ *  1(GCC)   | 1%     | 31.8      | 19.4   | 20.7
+ *  1(GCC)   | 10%    | 18.9      | 11.2   | 15.8
+ *
+ */
+
+#define BENCH_LOCK_FREE 1
+#define BENCH_RWLOCK 2
+#define BENCH_MUTEX 3
+
+
+#ifndef BENCH_TO_RUN
+#define BENCH_TO_RUN BENCH_LOCK_FREE
+#endif
+
+/* ops each thread runs per test */
+#ifndef BENCH_OPS
+#define BENCH_OPS 1000000
+#endif
+
+/* thread counts go 1, 2, 4 .. up to this */
+#ifndef BENCH_MAX_THREADS
+#define BENCH_MAX_THREADS 8
+#endif
+
+/* keys in the set before the test starts */
+#ifndef BENCH_PREFILL
+#define BENCH_PREFILL 4096
+#endif
+
+/* each run is a whole thread count / write percent test */
+#ifndef BENCH_SAMPLES
+#define BENCH_SAMPLES 3
+#endif
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <x86intrin.h>
+
+/* workers spread over the cores, pinning would put them all on one */
+#define HARNESS_NO_PIN
+#include "harness.h"
+
+/* same words as bench_strcmp.c, prefill adds generated keys on the end */
+const char *strings[] = {
+        "a", "b", "c", "1", "2", "3", "abc", "123",
+        "if", "else if", "else", "break", "continue", "for", "while", "do",
+        "goto", "struct", "int", "float", "unsigned", "double", "char", "const",
+        "cpu", "gpu", "memory", "keyboard", "screen", "mouse", "template",
+        "compiler", "type", "class", "jaffa cake", "then", "reduce", "reuse",
+        "recycle", "black cats", "kiteboard", "surfboard", "skateboard",
+        "wakeboard", "wobbleboard", "breadboard",
+        "A really long string that takes up space",
+        "This is also a longer string that takes up space, time, and sugar",
+        "Everybody jump jump! Everybody jump jump jump jump jump jump!",
+        "Flowers with purple spots, bannanas and apples",
+        "The Quick Brown Fox Jumped Over The Lazy Dog",
+        "Lorim Ipsum",
+        "Foo", "Bar", "Baz", "Bin", "Fin", "Fab", "Boo", "Far", "FooBar",
+        "FooBoo", "BarBar", "Faz", "FinFar", "FabFin", "BazBoo", "BarFoo",
+        "needle",
+        NULL
+};
+
+int write_pcts[] = { 0, 1, 10 };
+
+uint64_t
+hash_str(const char *str) {
+        uint64_t hash = 5381;
+        int c;
+        while(c = *str++, c) {
+          hash = ((hash << 5) + hash) + c;
+        }
+
+        return hash;
+}
+
+
+/* zero marks an empty slot */
+static inline uint64_t
+hash_key(const char *str) {
+        uint64_t hash = hash_str(str);
+        return hash ? hash : 1;
+}
+
+
+static inline uint64_t
+rand_next(uint64_t *state) {
+        uint64_t x = *state;
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        *state = x;
+        return x;
+}
+
+
+/* table */
+/* key is written before hash, readers acquire on hash then read key */
+struct set_slot {
+        _Atomic uint64_t hash;
+        const char * _Atomic key;
+};
+
+struct set_table {
+        uint64_t mask;
+        uint64_t count;
+        struct set_slot slots[];
+};
+
+/* one per reader thread, own cache line so announcing doesn't bounce */
+struct reader_epoch {
+        _Atomic uint64_t epoch;
+        char pad[64 - sizeof(uint64_t)];
+};
+
+struct string_set {
+        struct set_table * _Atomic table;
+        _Atomic uint64_t epoch;
+        pthread_mutex_t write_lock;
+        pthread_rwlock_t rw_lock;
+        struct reader_epoch readers[BENCH_MAX_THREADS];
+};
+
+
+struct set_table *
+table_create(uint64_t capacity) {
+        struct set_table *table = calloc(1, sizeof(struct set_table) +
+                capacity * sizeof(struct set_slot));
+        table->mask = capacity - 1;
+        table->count = 0;
+        return table;
+}
+
+
+static inline int
+table_find(struct set_table *table, const char *str, uint64_t hash) {
+        uint64_t i = hash & table->mask;
+
+        while(1) {
+                uint64_t slot_hash = atomic_load_explicit(&table->slots[i].hash,
+                        memory_order_acquire);
+
+                if(slot_hash == 0) {
+                        return 0;
+                }
+
+                if(slot_hash == hash) {
+                        const char *key = atomic_load_explicit(
+                                &table->slots[i].key, memory_order_relaxed);
+                        if(strcmp(key, str) == 0) {
+                                return 1;
+                        }
+                }
+
+                i = (i + 1) & table->mask;
+        }
+}
+
+
+/* writer only, caller makes sure there is room */
+int
+table_insert(struct set_table *table, const char *str, uint64_t hash) {
+        uint64_t i = hash & table->mask;
+
+        while(1) {
+                uint64_t slot_hash = atomic_load_explicit(&table->slots[i].hash,
+                        memory_order_relaxed);
+
+                if(slot_hash == 0) {
+                        break;
+                }
+
+                if(slot_hash == hash) {
+                        const char *key = atomic_load_explicit(
+                                &table->slots[i].key, memory_order_relaxed);
+                        if(strcmp(key, str) == 0) {
+                                return 0;
+                        }
+                }
+
+                i = (i + 1) & table->mask;
+        }
+
+        atomic_store_explicit(&table->slots[i].key, str, memory_order_relaxed);
+        atomic_store_explicit(&table->slots[i].hash, hash, memory_order_release);
+        table->count += 1;
+
+        return 1;
+}
+
+
+/* set */
+void
+set_init(struct string_set *set) {
+        int i;
+        atomic_init(&set->table, table_create(64));
+        atomic_init(&set->epoch, 1);
+        pthread_mutex_init(&set->write_lock, NULL);
+        pthread_rwlock_init(&set->rw_lock, NULL);
+
+        for(i = 0; i < BENCH_MAX_THREADS; ++i) {
+                atomic_init(&set->readers[i].epoch, 0);
+        }
+}
+
+
+void
+set_destroy(struct string_set *set) {
+        free(atomic_load(&set->table));
+        pthread_mutex_destroy(&set->write_lock);
+        pthread_rwlock_destroy(&set->rw_lock);
+}
+
+
+/* waits until no reader can still be looking at a table unlinked before
+   this call */
+void
+set_synchronize(struct string_set *set) {
+        uint64_t epoch = atomic_fetch_add(&set->epoch, 1) + 1;
+        int i;
+
+        for(i = 0; i < BENCH_MAX_THREADS; ++i) {
+                while(1) {
+                        uint64_t seen = atomic_load(&set->readers[i].epoch);
+                        if(seen == 0 || seen >= epoch) {
+                                break;
+                        }
+                        _mm_pause();
+                }
+        }
+}
+
+
+/* grows the table if the insert would take it over 1/2 full, caller holds
+   whichever lock guards writers */
+void
+set_reserve(struct string_set *set, int reclaim) {
+        struct set_table *old = atomic_load_explicit(&set->table,
+                memory_order_relaxed);
+
+        if((old->count + 1) * 2 <= old->mask + 1) {
+                return;
+        }
+
+        struct set_table *table = table_create((old->mask + 1) * 2);
+        uint64_t i;
+        for(i = 0; i <= old->mask; ++i) {
+                uint64_t hash = atomic_load_explicit(&old->slots[i].hash,
+                        memory_order_relaxed);
+                if(hash) {
+                        table_insert(table, atomic_load_explicit(
+                                &old->slots[i].key, memory_order_relaxed),
+                                hash);
+                }
+        }
+
+        atomic_store(&set->table, table);
+
+        if(reclaim) {
+                set_synchronize(set);
+        }
+
+        free(old);
+}
+
+
+/* lock free readers */
+static inline int
+set_contains_lock_free(
+        struct string_set *set,
+        int reader,
+        const char *str,
+        uint64_t hash)
+{
+        struct reader_epoch *rd = &set->readers[reader];
+
+        atomic_store(&rd->epoch, atomic_load_explicit(&set->epoch,
+                memory_order_acquire));
+
+        struct set_table *table = atomic_load(&set->table);
+        int found = table_find(table, str, hash);
+
+        atomic_store_explicit(&rd->epoch, 0, memory_order_release);
+
+        return found;
+}
+
+
+int
+set_insert_lock_free(struct string_set *set, const char *str, uint64_t hash) {
+        pthread_mutex_lock(&set->write_lock);
+        set_reserve(set, 1);
+        int added = table_insert(atomic_load_explicit(&set->table,
+                memory_order_relaxed), str, hash);
+        pthread_mutex_unlock(&set->write_lock);
+
+        return added;
+}
+
+
+/* rwlock */
+static inline int
+set_contains_rwlock(struct string_set *set, const char *str, uint64_t hash) {
+        pthread_rwlock_rdlock(&set->rw_lock);
+        int found = table_find(atomic_load_explicit(&set->table,
+                memory_order_relaxed), str, hash);
+        pthread_rwlock_unlock(&set->rw_lock);
+
+        return found;
+}
+
+
+int
+set_insert_rwlock(struct string_set *set, const char *str, uint64_t hash) {
+        pthread_rwlock_wrlock(&set->rw_lock);
+        set_reserve(set, 0);
+        int added = table_insert(atomic_load_explicit(&set->table,
+                memory_order_relaxed), str, hash);
+        pthread_rwlock_unlock(&set->rw_lock);
+
+        return added;
+}
+
+
+/* mutex */
+static inline int
+set_contains_mutex(struct string_set *set, const char *str, uint64_t hash) {
+        pthread_mutex_lock(&set->write_lock);
+        int found = table_find(atomic_load_explicit(&set->table,
+                memory_order_relaxed), str, hash);
+        pthread_mutex_unlock(&set->write_lock);
+
+        return found;
+}
+
+
+int
+set_insert_mutex(struct string_set *set, const char *str, uint64_t hash) {
+        pthread_mutex_lock(&set->write_lock);
+        set_reserve(set, 0);
+        int added = table_insert(atomic_load_explicit(&set->table,
+                memory_order_relaxed), str, hash);
+        pthread_mutex_unlock(&set->write_lock);
+
+        return added;
+}
+
+
+/* test data */
+/* queries are prefilled keys plus some that are never inserted */
+struct query {
+        const char *str;
+        uint64_t hash;
+};
+
+char **prefill_keys = 0;
+uint64_t prefill_count = 0;
+
+struct query *queries = 0;
+uint64_t query_count = 0;
+
+void
+build_keys() {
+        uint64_t word_count = 0;
+        uint64_t i;
+        char buf[64];
+
+        while(strings[word_count]) {
+                ++word_count;
+        }
+
+        prefill_count = BENCH_PREFILL;
+        prefill_keys = malloc(prefill_count * sizeof(char*));
+        for(i = 0; i < prefill_count; ++i) {
+                if(i < word_count) {
+                        prefill_keys[i] = strdup(strings[i]);
+                } else {
+                        snprintf(buf, sizeof(buf), "%s_%llu",
+                                strings[i % word_count], (unsigned long long)i);
+                        prefill_keys[i] = strdup(buf);
+                }
+        }
+
+        /* 1 in 4 queries miss */
+        query_count = prefill_count + prefill_count / 3;
+        queries = malloc(query_count * sizeof(struct query));
+        for(i = 0; i < query_count; ++i) {
+                if(i < prefill_count) {
+                        queries[i].str = prefill_keys[i];
+                } else {
+                        snprintf(buf, sizeof(buf), "missing_%llu",
+                                (unsigned long long)i);
+                        queries[i].str = strdup(buf);
+                }
+                queries[i].hash = hash_key(queries[i].str);
+        }
+}
+
+
+/* worker */
+struct worker {
+        pthread_t thread;
+        struct string_set *set;
+        pthread_barrier_t *barrier;
+        int id;
+        int write_pct;
+
+        /* unique keys this thread inserts, made before the clock starts */
+        char **insert_keys;
+        uint64_t insert_count;
+
+        uint64_t lookups;
+        uint64_t found;
+        uint64_t inserts;
+};
+
+
+void *
+worker_run(void *arg) {
+        struct worker *w = arg;
+        struct string_set *set = w->set;
+        uint64_t rng = 0x9E3779B97F4A7C15ull * (w->id + 1);
+        uint64_t next_insert = 0;
+        uint64_t lookups = 0;
+        uint64_t found = 0;
+        uint64_t i;
+
+        pthread_barrier_wait(w->barrier);
+
+        for(i = 0; i < BENCH_OPS; ++i) {
+                uint64_t r = rand_next(&rng);
+
+                if((int)(r % 100) < w->write_pct &&
+                   next_insert < w->insert_count) {
+                        const char *key = w->insert_keys[next_insert++];
+                        uint64_t hash = hash_key(key);
+
+                        if(BENCH_TO_RUN == BENCH_LOCK_FREE) {
+                                set_insert_lock_free(set, key, hash);
+                        } else if(BENCH_TO_RUN == BENCH_RWLOCK) {
+                                set_insert_rwlock(set, key, hash);
+                        } else if(BENCH_TO_RUN == BENCH_MUTEX) {
+                                set_insert_mutex(set, key, hash);
+                        }
+                        continue;
+                }
+
+                struct query *q = &queries[(r >> 8) % query_count];
+
+                if(BENCH_TO_RUN == BENCH_LOCK_FREE) {
+                        found += set_contains_lock_free(set, w->id, q->str,
+                                q->hash);
+                } else if(BENCH_TO_RUN == BENCH_RWLOCK) {
+                        found += set_contains_rwlock(set, q->str, q->hash);
+                } else if(BENCH_TO_RUN == BENCH_MUTEX) {
+                        found += set_contains_mutex(set, q->str, q->hash);
+                }
+
+                lookups += 1;
+        }
+
+        w->lookups = lookups;
+        w->found = found;
+        w->inserts = next_insert;
+
+        pthread_barrier_wait(w->barrier);
+
+        return 0;
+}
+
+
+/* totals from the last run */
+uint64_t lookup_count = 0;
+uint64_t found_count = 0;
+uint64_t insert_count = 0;
+uint64_t set_size = 0;
+uint64_t elapsed_cycles = 0;
+
+
+/* runs one thread count / write percent, returns lookups/sec */
+double
+bench_set(int threads, int write_pct) {
+        struct string_set set;
+        struct worker workers[BENCH_MAX_THREADS];
+        pthread_barrier_t barrier;
+        uint64_t i;
+        int t;
+
+        set_init(&set);
+        for(i = 0; i < prefill_count; ++i) {
+                set_insert_mutex(&set, prefill_keys[i], hash_key(prefill_keys[i]));
+        }
+
+        pthread_barrier_init(&barrier, NULL, threads + 1);
+
+        for(t = 0; t < threads; ++t) {
+                struct worker *w = &workers[t];
+                char buf[64];
+
+                w->set = &set;
+                w->barrier = &barrier;
+                w->id = t;
+                w->write_pct = write_pct;
+                w->insert_count = (uint64_t)BENCH_OPS * write_pct / 100 * 2;
+                w->insert_keys = malloc((w->insert_count + 1) * sizeof(char*));
+
+                for(i = 0; i < w->insert_count; ++i) {
+                        snprintf(buf, sizeof(buf), "t%d_%llu", t,
+                                (unsigned long long)i);
+                        w->insert_keys[i] = strdup(buf);
+                }
+
+                pthread_create(&w->thread, NULL, worker_run, w);
+        }
+
+        pthread_barrier_wait(&barrier);
+        uint64_t start_ns = get_time_ns();
+        uint64_t start = get_time_rdtsc();
+
+        pthread_barrier_wait(&barrier);
+        uint64_t end = get_time_rdtsc();
+        uint64_t ns = get_time_ns() - start_ns;
+
+        uint64_t lookups = 0;
+        uint64_t found = 0;
+        uint64_t inserts = 0;
+
+        for(t = 0; t < threads; ++t) {
+                pthread_join(workers[t].thread, NULL);
+                lookups += workers[t].lookups;
+                found += workers[t].found;
+                inserts += workers[t].inserts;
+        }
+
+        struct set_table *table = atomic_load(&set.table);
+        lookup_count = lookups;
+        found_count = found;
+        insert_count = inserts;
+        set_size = table->count;
+        elapsed_cycles = end - start;
+
+        /* keys can only go once the set is gone */
+        set_destroy(&set);
+        for(t = 0; t < threads; ++t) {
+                for(i = 0; i < workers[t].insert_count; ++i) {
+                        free(workers[t].insert_keys[i]);
+                }
+                free(workers[t].insert_keys);
+        }
+        pthread_barrier_destroy(&barrier);
+
+        return (double)lookups * 1e9 / (double)ns;
+}
+
+
+/* Benchmark */
+int
+main() {
+        const char *name = "";
+        int p, threads, i;
+
+        if(BENCH_TO_RUN == BENCH_LOCK_FREE) {
+                name = "lock free";
+        } else if(BENCH_TO_RUN == BENCH_RWLOCK) {
+                name = "rwlock";
+        } else if(BENCH_TO_RUN == BENCH_MUTEX) {
+                name = "mutex";
+        }
+
+        build_keys();
+
+        for(p = 0; p < (int)(sizeof(write_pcts) / sizeof(write_pcts[0])); ++p) {
+                for(threads = 1; threads <= BENCH_MAX_THREADS; threads *= 2) {
+                        struct harness h;
+                        char inputs[64];
+
+                        snprintf(inputs, sizeof(inputs),
+                                "%d threads %d%% writes", threads,
+                                write_pcts[p]);
+
+                        harness_begin(&h, "concurrent_set", name, inputs,
+                                "lookups/sec", 0);
+                        for(i = 0; i < BENCH_SAMPLES; ++i) {
+                                harness_sample(&h, bench_set(threads,
+                                        write_pcts[p]));
+                        }
+                        harness_report(&h);
+
+                        printf("Threads/Writes: %d %d%%\n", threads,
+                                write_pcts[p]);
+                        printf("Lookups/Found/Inserts: %llu %llu %llu\n",
+                                (unsigned long long)lookup_count,
+                                (unsigned long long)found_count,
+                                (unsigned long long)insert_count);
+                        printf("Set size: %llu\n",
+                                (unsigned long long)set_size);
+                        printf("Cycles: %llu\n",
+                                (unsigned long long)elapsed_cycles);
+                        printf("%s: %.0f lookups/sec\n--\n", name, h.max);
+                }
+        }
+
+        return 0;
+}
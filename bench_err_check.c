@@ -7,8 +7,14 @@
  * 
  * - Error checking with Table vs Branches
  * - Using RTDSC timer
+ * - Runs through harness.h, printed time is the fastest sample
  * - Sample size needs to bigger
  * - Maybe should run these tests indiviudally
+ * - BENCH_SWEEP=1 repeats the inputs out to past LLC size, BENCH_CACHE=cold
+ *   flushes them before each run, see harness.h
+ * - BENCH_INPUTS=mixed|valid at run time overrides the build's inputs,
+ *   make pgo uses it to run a trained build on both
+ * - -DBENCH_LATENCY records each check into a histogram, see harness.h
  *
  * Platforms
  * ---------
@@ -80,6 +86,8 @@
 #include <stdio.h>
 #include <x86intrin.h>
 
+#include "harness.h"
+
 
 /* Benchmark checks this that the envelope is valid */
 /* top left corner must be less than bottom right corner */
@@ -214,10 +222,9 @@ uint64_t valid_inputs_count = (sizeof(valid_inputs) / sizeof(valid_inputs[0]));
 
 #define unlikely(x)     __builtin_expect((x),0)
 
-uint64_t
-get_time_rdtsc() {
-  return __builtin_ia32_rdtsc();  
-}
+/* results of the last run, kept so the checks can't be optimised out */
+uint64_t valid_count = 0;
+uint64_t invalid_count = 0;
 
 /* checks inputs with indivual if statements */
 uint64_t
@@ -228,9 +235,9 @@ bench_error_branches(
         uint64_t i;
         uint64_t invalid = 0;
         uint64_t valid = 0;
-        uint64_t start = get_time_rdtsc();
+        uint64_t start = harness_start();
 
-        for(i = 0; i < input_count; ++i) {
+        for(i = 0; i < input_count; ++i, HARNESS_OP()) {
                 if(inputs[i].top_left_x > inputs[i].bot_right_x) {
                         invalid += 1;
                         continue;
@@ -264,9 +271,10 @@ bench_error_branches(
                 valid += 1;
         }
 
-  uint64_t end = get_time_rdtsc();
+  uint64_t end = harness_stop();
 
-  printf("Valid/Invalid: %llu %llu\n", valid, invalid);
+  valid_count = valid;
+  invalid_count = invalid;
   
   return end - start;
 }
@@ -280,9 +288,9 @@ bench_error_unlikely_branches(
         uint64_t i;
         uint64_t invalid = 0;
         uint64_t valid = 0;
-        uint64_t start = get_time_rdtsc();
+        uint64_t start = harness_start();
 
-        for(i = 0; i < input_count; ++i) {
+        for(i = 0; i < input_count; ++i, HARNESS_OP()) {
                 if(unlikely(inputs[i].top_left_x > inputs[i].bot_right_x)) {
                         invalid += 1;
                         continue;
@@ -316,9 +324,10 @@ bench_error_unlikely_branches(
                 valid += 1;
         }
 
-  uint64_t end = get_time_rdtsc();
+  uint64_t end = harness_stop();
 
-  printf("Valid/Invalid: %llu %llu\n", valid, invalid);
+  valid_count = valid;
+  invalid_count = invalid;
   
   return end - start;
 }
@@ -333,9 +342,9 @@ bench_error_giant_check(
         uint64_t i;
         uint64_t invalid = 0;
         uint64_t valid = 0;
-        uint64_t start = get_time_rdtsc();
+        uint64_t start = harness_start();
 
-        for(i = 0; i < input_count; ++i) {
+        for(i = 0; i < input_count; ++i, HARNESS_OP()) {
                 if((inputs[i].top_left_x > inputs[i].bot_right_x) ||
                    (inputs[i].top_left_y > inputs[i].bot_right_y) ||
                    (inputs[i].top_left_x > 100) ||
@@ -349,9 +358,10 @@ bench_error_giant_check(
                 valid += 1;
         }
 
-  uint64_t end = get_time_rdtsc();
+  uint64_t end = harness_stop();
 
-  printf("Valid/Invalid: %llu %llu\n", valid, invalid);
+  valid_count = valid;
+  invalid_count = invalid;
   
   return end - start;
 }
@@ -365,9 +375,9 @@ bench_error_unlikely_giant_check(
         uint64_t i;
         uint64_t invalid = 0;
         uint64_t valid = 0;
-        uint64_t start = get_time_rdtsc();
+        uint64_t start = harness_start();
 
-        for(i = 0; i < input_count; ++i) {
+        for(i = 0; i < input_count; ++i, HARNESS_OP()) {
                 if(unlikely((inputs[i].top_left_x > inputs[i].bot_right_x) ||
                    (inputs[i].top_left_y > inputs[i].bot_right_y) ||
                    (inputs[i].top_left_x > 100) ||
@@ -381,9 +391,10 @@ bench_error_unlikely_giant_check(
                 valid += 1;
         }
 
-  uint64_t end = get_time_rdtsc();
+  uint64_t end = harness_stop();
 
-  printf("Valid/Invalid: %llu %llu\n", valid, invalid);
+  valid_count = valid;
+  invalid_count = invalid;
   
   return end - start;
 }
@@ -397,9 +408,9 @@ bench_error_branch_tree(
         uint64_t i;
         uint64_t invalid = 0;
         uint64_t valid = 0;
-        uint64_t start = get_time_rdtsc();
+        uint64_t start = harness_start();
 
-        for(i = 0; i < input_count; ++i) {
+        for(i = 0; i < input_count; ++i, HARNESS_OP()) {
                 if(inputs[i].top_left_x > inputs[i].bot_right_x) {
                         invalid += 1;
                         continue;
@@ -433,9 +444,10 @@ bench_error_branch_tree(
                 valid += 1;
         }
 
-        uint64_t end = get_time_rdtsc();
+        uint64_t end = harness_stop();
 
-        printf("Valid/Invalid: %llu %llu\n", valid, invalid);
+        valid_count = valid;
+        invalid_count = invalid;
 
         return end - start;
 }
@@ -450,9 +462,9 @@ bench_error_unlikely_branch_tree(
         uint64_t i;
         uint64_t invalid = 0;
         uint64_t valid = 0;
-        uint64_t start = get_time_rdtsc();
+        uint64_t start = harness_start();
 
-        for(i = 0; i < input_count; ++i) {
+        for(i = 0; i < input_count; ++i, HARNESS_OP()) {
                 if(unlikely(inputs[i].top_left_x > inputs[i].bot_right_x)) {
                         invalid += 1;
                         continue;
@@ -486,9 +498,10 @@ bench_error_unlikely_branch_tree(
                 valid += 1;
         }
 
-        uint64_t end = get_time_rdtsc();
+        uint64_t end = harness_stop();
 
-        printf("Valid/Invalid: %llu %llu\n", valid, invalid);
+        valid_count = valid;
+        invalid_count = invalid;
 
         return end - start;
 }
@@ -502,9 +515,9 @@ bench_error_table(
         uint64_t i;
         uint64_t invalid = 0;
         uint64_t valid = 0;
-        uint64_t start = get_time_rdtsc();
+        uint64_t start = harness_start();
 
-        for(i = 0; i < input_count; ++i) {
+        for(i = 0; i < input_count; ++i, HARNESS_OP()) {
                 uint64_t err = 0;
 
                 /* each bit represents a particular  */
@@ -522,9 +535,10 @@ bench_error_table(
                 }
         }
 
-        uint64_t end = get_time_rdtsc();
+        uint64_t end = harness_stop();
 
-        printf("Valid/Invalid: %llu %llu\n", valid, invalid);
+        valid_count = valid;
+        invalid_count = invalid;
 
         return end - start;
 }
@@ -539,79 +553,163 @@ bench_error_no_check(
         uint64_t i;
         volatile uint64_t invalid = 0;
         volatile uint64_t valid = 0;
-        uint64_t start = get_time_rdtsc();
-
-        for(i = 0; i < input_count; ++i) {
-                uint64_t err = 0;
+        uint64_t start = harness_start();
 
+        for(i = 0; i < input_count; ++i, HARNESS_OP()) {
                 valid += 1;
         }
 
-        uint64_t end = get_time_rdtsc();
+        uint64_t end = harness_stop();
 
-        printf("Valid/Invalid: %llu %llu\n", valid, invalid);
+        valid_count = valid;
+        invalid_count = invalid;
 
         return end - start;
 }
 
 
 
+/* runs one input set through the harness, per element when sweeping */
+double
+run_samples(
+        uint64_t (*bench)(struct env*, uint64_t),
+        const char *name,
+        struct env *inputs,
+        uint64_t count,
+        const char *inputs_name,
+        int per_element)
+{
+        struct harness h;
+        int cold = harness_cold();
+        char full_name[HARNESS_NAME_MAX + sizeof(" cold")];
+        int i;
+
+        snprintf(full_name, sizeof(full_name), "%s%s", inputs_name,
+                cold ? " cold" : "");
+
+        harness_begin(&h, "err_check", name, full_name,
+                per_element ? "cycles/element" : "cycles", 1);
+        for(i = 0; i < BENCH_SAMPLES; ++i) {
+                if(cold) {
+                        harness_flush(inputs, count * sizeof(struct env));
+                }
+
+                double cycles = (double)bench(inputs, count);
+                harness_sample(&h, per_element ? cycles / count : cycles);
+        }
+        harness_report(&h);
+
+        return h.min;
+}
+
+
 /* Benchmark */
 int
 main() {
         /* input data */
         struct env *inputs = 0;
         uint64_t count = 0;
+        const char *inputs_name = harness_inputs(
+                BENCH_INPUTS == BENCH_VALID_INPUTS ? "valid" : "mixed");
 
-        if(BENCH_INPUTS == BENCH_MIXED_INPUTS) {
+        if(strcmp(inputs_name, "mixed") == 0) {
                 inputs = mixed_inputs;
                 count = mixed_inputs_count;
-        } else if (BENCH_INPUTS == BENCH_VALID_INPUTS) {
+        } else if(strcmp(inputs_name, "valid") == 0) {
                 inputs = valid_inputs;
                 count = valid_inputs_count;
+        } else {
+                fprintf(stderr, "Unknown inputs %s, mixed or valid\n",
+                        inputs_name);
+                return 1;
         }
-  
+
         /* benchmarks */
+        uint64_t (*bench)(struct env*, uint64_t) = 0;
+        const char *name = "";
+
         if(BENCH_TO_RUN == BENCH_BRANCHES) {
-                printf("branches: %llu\n--\n",
-                        bench_error_branches(inputs, count));
+                bench = bench_error_branches;
+                name = "branches";
         }
 
         if(BENCH_TO_RUN == BENCH_BRANCHES_HINTS) {
-                printf("unlikely branches: %llu\n--\n",
-                        bench_error_unlikely_branches(inputs, count));
+                bench = bench_error_unlikely_branches;
+                name = "unlikely branches";
         }
 
         if(BENCH_TO_RUN == BENCH_GIANT) {
-                printf("giant check: %llu\n--\n",
-                        bench_error_giant_check(inputs, count));
-
+                bench = bench_error_giant_check;
+                name = "giant check";
         }
 
         if(BENCH_TO_RUN == BENCH_GIANT_HINTS) {
-                printf("unlikely giant check: %llu\n--\n",
-                        bench_error_unlikely_giant_check(inputs, count));
+                bench = bench_error_unlikely_giant_check;
+                name = "unlikely giant check";
         }
-        
+
         if(BENCH_TO_RUN == BENCH_TREE) {
-                printf("branch tree: %llu\n--\n",
-                        bench_error_branch_tree(inputs, count));
+                bench = bench_error_branch_tree;
+                name = "branch tree";
         }
 
         if(BENCH_TO_RUN == BENCH_TREE_HINTS) {
-                printf("unlikely branch tree: %llu\n--\n",
-                        bench_error_unlikely_branch_tree(inputs, count));
+                bench = bench_error_unlikely_branch_tree;
+                name = "unlikely branch tree";
         }
 
         if(BENCH_TO_RUN == BENCH_TABLE) {
-                printf("Error Table: %llu\n--\n",
-                        bench_error_table(inputs, count));
+                bench = bench_error_table;
+                name = "error table";
         }
 
         if(BENCH_TO_RUN == BENCH_NONE) {
-                printf("No check: %llu\n--\n",
-                        bench_error_no_check(inputs, count));
+                bench = bench_error_no_check;
+                name = "no check";
+        }
+
+        if(!harness_sweep()) {
+                double best = run_samples(bench, name, inputs, count,
+                        inputs_name, 0);
+
+                printf("Valid/Invalid: %llu %llu\n",
+                        (unsigned long long)valid_count,
+                        (unsigned long long)invalid_count);
+                printf("%s: %llu\n--\n", name, (unsigned long long)best);
+
+                return 0;
+        }
+
+        /* same pattern of inputs, repeated out to each size */
+        uint64_t sizes[HARNESS_SWEEP_MAX];
+        int size_count = harness_sweep_sizes(sizes, HARNESS_SWEEP_MAX);
+        int s;
+
+        for(s = 0; s < size_count; ++s) {
+                uint64_t set_count = sizes[s] / sizeof(struct env);
+                struct env *set = malloc(set_count * sizeof(struct env));
+                char size_name[32], set_name[HARNESS_NAME_MAX];
+                uint64_t j;
+
+                for(j = 0; j < set_count; ++j) {
+                        set[j] = inputs[j % count];
+                }
+
+                snprintf(set_name, sizeof(set_name), "%s %s", inputs_name,
+                        harness_size_name(sizes[s], size_name,
+                        sizeof(size_name)));
+
+                double best = run_samples(bench, name, set, set_count,
+                        set_name, 1);
+
+                printf("%s %s: %.3f cycles/element\n", name, set_name, best);
+
+                free(set);
         }
 
+        printf("Valid/Invalid: %llu %llu\n--\n",
+                (unsigned long long)valid_count,
+                (unsigned long long)invalid_count);
+
         return 0;
 }
@@ -0,0 +1,696 @@
+/*
+ * Keyword Classification Benchmarks
+ * =================================
+ *
+ * Lexers spend alot of time deciding if an identifier is a keyword. Quick
+ * bench to tokenize a generated C like text and classify each identifier.
+ *
+ * - if chain of strcmp (like bench_strcmp.c)
+ * - switch on length then first char
+ * - switch on djb2 hash (like bench_hash_rt in bench_strcmp.c)
+ * - perfect hash over the first 8 bytes of the token
+ * - SSE2 16 byte compare against a packed keyword table
+ * - Using RTDSC timer, tokens/sec from the monotonic clock
+ * - Runs through harness.h, printed numbers are the best sample
+ * - Tokens are copied into a zero padded buffer, all variants pay for that
+ *
+ * Platforms
+ * ---------
+ *
+ * 1.
+ * Linux Debian 12 - Intel(R) Xeon(R) Processor
+ * gcc bench_keywords.c -DBENCH_TO_RUN=BENCH_<TEST> -O3 (GCC 12.2.0)
+ *
+ * Results
+ * -------
+ *
+ * _Note:_ 1MB of text, 30% keywords
+ * _Note:_ Cycles, brackets are millions of tokens/sec
+ *
+ *  Platform | strcmp chain | len switch   | hash switch  | perfect hash | simd
+ * ==========|==============|==============|==============|==============|=============
+ *  1(GCC)   | 25225k(10.2) | 14011k(18.4) | 17980k(14.4) | 12220k(21.2) | 14180k(18.2)
+ *
+ */
+
+#define BENCH_STRCMP_CHAIN 1
+#define BENCH_LEN_SWITCH 2
+#define BENCH_HASH_SWITCH 3
+#define BENCH_PERFECT_HASH 4
+#define BENCH_SIMD 5
+
+
+#ifndef BENCH_TO_RUN
+#define BENCH_TO_RUN BENCH_STRCMP_CHAIN
+#endif
+
+/* size of the generated text in bytes */
+#ifndef BENCH_TEXT_SIZE
+#define BENCH_TEXT_SIZE (1024 * 1024)
+#endif
+
+/* percentage of generated identifiers that are keywords */
+#ifndef BENCH_KEYWORD_PCT
+#define BENCH_KEYWORD_PCT 30
+#endif
+
+/* each run tokenizes the whole text, so fewer than the harness default */
+#ifndef BENCH_SAMPLES
+#define BENCH_SAMPLES 11
+#endif
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include <x86intrin.h>
+
+#include "harness.h"
+
+/* C89 keywords */
+const char *keywords[] = {
+        "auto", "break", "case", "char", "const", "continue", "default", "do",
+        "double", "else", "enum", "extern", "float", "for", "goto", "if",
+        "int", "long", "register", "return", "short", "signed", "sizeof",
+        "static", "struct", "switch", "typedef", "union", "unsigned", "void",
+        "volatile", "while",
+        NULL
+};
+
+/* identifiers that are not keywords, some are close to keywords */
+const char *identifiers[] = {
+        "a", "b", "c", "abc", "i", "j", "len", "str", "count", "data",
+        "cpu", "gpu", "memory", "keyboard", "screen", "mouse", "template",
+        "compiler", "type", "class", "then", "reduce", "reuse", "recycle",
+        "kiteboard", "surfboard", "skateboard", "wakeboard", "wobbleboard",
+        "breadboard", "Foo", "Bar", "Baz", "Bin", "Fin", "Fab", "Boo", "Far",
+        "FooBar", "FooBoo", "BarBar", "Faz", "FinFar", "FabFin", "BazBoo",
+        "BarFoo", "iff", "dot", "integer", "forward", "casey", "charm",
+        "breaking", "constant", "doubled", "elsewhere", "structure",
+        "unsigned_int", "voidptr", "whilst", "go", "fo", "in",
+        NULL
+};
+
+const char *separators[] = {
+        " ", " ", " ", "(", ") ", ";\n", " = ", " {\n", "}\n", ", ", " + 1",
+        "[0]", "->", ".", " * ", " == 42 ",
+        NULL
+};
+
+uint64_t
+hash_str(const char *str) {
+        uint64_t hash = 5381;
+        int c;
+        while(c = *str++, c) {
+          hash = ((hash << 5) + hash) + c;
+        }
+
+        return hash;
+}
+
+
+/* xorshift, same sequence every run */
+uint64_t rand_state = 0x2545F4914F6CDD1Dull;
+
+uint64_t
+rand_next() {
+        rand_state ^= rand_state << 13;
+        rand_state ^= rand_state >> 7;
+        rand_state ^= rand_state << 17;
+        return rand_state;
+}
+
+
+uint64_t
+count_of(const char **arr) {
+        uint64_t count = 0;
+        while(arr[count]) {
+                ++count;
+        }
+
+        return count;
+}
+
+
+/* fills text with identifiers, keywords and punctuation */
+char *
+generate_text(uint64_t size) {
+        char *text = malloc(size + 1);
+        uint64_t kw_count = count_of(keywords);
+        uint64_t id_count = count_of(identifiers);
+        uint64_t sep_count = count_of(separators);
+        uint64_t len = 0;
+
+        while(1) {
+                const char *word = 0;
+                const char *sep = separators[rand_next() % sep_count];
+
+                if((rand_next() % 100) < BENCH_KEYWORD_PCT) {
+                        word = keywords[rand_next() % kw_count];
+                } else {
+                        word = identifiers[rand_next() % id_count];
+                }
+
+                uint64_t word_len = strlen(word);
+                uint64_t sep_len = strlen(sep);
+
+                if(len + word_len + sep_len >= size) {
+                        break;
+                }
+
+                memcpy(text + len, word, word_len);
+                len += word_len;
+                memcpy(text + len, sep, sep_len);
+                len += sep_len;
+        }
+
+        memset(text + len, ' ', size - len);
+        text[size] = 0;
+
+        return text;
+}
+
+
+/* tokenizer */
+/* copies the next identifier into tok, zero padded to 16 bytes */
+/* tokens longer than 15 chars are not copied and can't be keywords */
+static inline int
+is_ident_start(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+
+static inline int
+is_ident_char(char c) {
+        return is_ident_start(c) || (c >= '0' && c <= '9');
+}
+
+
+static inline int
+next_token(const char **it, char *tok) {
+        const char *p = *it;
+
+        while(*p && !is_ident_start(*p)) {
+                /* skip numbers whole so 0x10 isn't an identifier */
+                if(*p >= '0' && *p <= '9') {
+                        while(is_ident_char(*p)) {
+                                ++p;
+                        }
+                        continue;
+                }
+                ++p;
+        }
+
+        if(!*p) {
+                *it = p;
+                return -1;
+        }
+
+        const char *start = p;
+        while(is_ident_char(*p)) {
+                ++p;
+        }
+
+        int len = (int)(p - start);
+        *it = p;
+
+        memset(tok, 0, 16);
+        if(len < 16) {
+                memcpy(tok, start, len);
+        }
+
+        return len;
+}
+
+
+/* classifiers */
+/* each returns non zero if tok (len chars, zero padded) is a keyword */
+static inline int
+is_keyword_strcmp(const char *tok, int len) {
+        if(strcmp(tok, "auto") == 0) { return 1; }
+        else if(strcmp(tok, "break") == 0) { return 1; }
+        else if(strcmp(tok, "case") == 0) { return 1; }
+        else if(strcmp(tok, "char") == 0) { return 1; }
+        else if(strcmp(tok, "const") == 0) { return 1; }
+        else if(strcmp(tok, "continue") == 0) { return 1; }
+        else if(strcmp(tok, "default") == 0) { return 1; }
+        else if(strcmp(tok, "do") == 0) { return 1; }
+        else if(strcmp(tok, "double") == 0) { return 1; }
+        else if(strcmp(tok, "else") == 0) { return 1; }
+        else if(strcmp(tok, "enum") == 0) { return 1; }
+        else if(strcmp(tok, "extern") == 0) { return 1; }
+        else if(strcmp(tok, "float") == 0) { return 1; }
+        else if(strcmp(tok, "for") == 0) { return 1; }
+        else if(strcmp(tok, "goto") == 0) { return 1; }
+        else if(strcmp(tok, "if") == 0) { return 1; }
+        else if(strcmp(tok, "int") == 0) { return 1; }
+        else if(strcmp(tok, "long") == 0) { return 1; }
+        else if(strcmp(tok, "register") == 0) { return 1; }
+        else if(strcmp(tok, "return") == 0) { return 1; }
+        else if(strcmp(tok, "short") == 0) { return 1; }
+        else if(strcmp(tok, "signed") == 0) { return 1; }
+        else if(strcmp(tok, "sizeof") == 0) { return 1; }
+        else if(strcmp(tok, "static") == 0) { return 1; }
+        else if(strcmp(tok, "struct") == 0) { return 1; }
+        else if(strcmp(tok, "switch") == 0) { return 1; }
+        else if(strcmp(tok, "typedef") == 0) { return 1; }
+        else if(strcmp(tok, "union") == 0) { return 1; }
+        else if(strcmp(tok, "unsigned") == 0) { return 1; }
+        else if(strcmp(tok, "void") == 0) { return 1; }
+        else if(strcmp(tok, "volatile") == 0) { return 1; }
+        else if(strcmp(tok, "while") == 0) { return 1; }
+
+        return 0;
+}
+
+
+/* length too, a hash hit can be a longer token that starts with s */
+#define KW_IS(s) (len == sizeof(s) - 1 && memcmp(tok, s, sizeof(s) - 1) == 0)
+
+static inline int
+is_keyword_len_switch(const char *tok, int len) {
+        switch(len) {
+        case 2:
+                switch(tok[0]) {
+                case 'd': return KW_IS("do");
+                case 'i': return KW_IS("if");
+                }
+                return 0;
+        case 3:
+                switch(tok[0]) {
+                case 'f': return KW_IS("for");
+                case 'i': return KW_IS("int");
+                }
+                return 0;
+        case 4:
+                switch(tok[0]) {
+                case 'a': return KW_IS("auto");
+                case 'c': return KW_IS("case") || KW_IS("char");
+                case 'e': return KW_IS("else") || KW_IS("enum");
+                case 'g': return KW_IS("goto");
+                case 'l': return KW_IS("long");
+                case 'v': return KW_IS("void");
+                }
+                return 0;
+        case 5:
+                switch(tok[0]) {
+                case 'b': return KW_IS("break");
+                case 'c': return KW_IS("const");
+                case 'f': return KW_IS("float");
+                case 's': return KW_IS("short");
+                case 'u': return KW_IS("union");
+                case 'w': return KW_IS("while");
+                }
+                return 0;
+        case 6:
+                switch(tok[0]) {
+                case 'd': return KW_IS("double");
+                case 'e': return KW_IS("extern");
+                case 'r': return KW_IS("return");
+                case 's': return KW_IS("signed") || KW_IS("sizeof") ||
+                                 KW_IS("static") || KW_IS("struct") ||
+                                 KW_IS("switch");
+                }
+                return 0;
+        case 7:
+                switch(tok[0]) {
+                case 'd': return KW_IS("default");
+                case 't': return KW_IS("typedef");
+                }
+                return 0;
+        case 8:
+                switch(tok[0]) {
+                case 'c': return KW_IS("continue");
+                case 'r': return KW_IS("register");
+                case 'u': return KW_IS("unsigned");
+                case 'v': return KW_IS("volatile");
+                }
+                return 0;
+        }
+
+        return 0;
+}
+
+
+/* case labels are djb2 of each keyword, a hit still gets verified */
+static inline int
+is_keyword_hash_switch(const char *tok, int len) {
+        switch(hash_str(tok)) {
+        case 0x17c94415eull: return KW_IS("auto");
+        case 0x310f2c9f4aull: return KW_IS("break");
+        case 0x17c9504e1ull: return KW_IS("case");
+        case 0x17c952063ull: return KW_IS("char");
+        case 0x310f3d3b4cull: return KW_IS("const");
+        case 0x1ae6ec42aefb8aull: return KW_IS("continue");
+        case 0xd0b20885548aull: return KW_IS("default");
+        case 0x597798ull: return KW_IS("do");
+        case 0x652f93d5b20ull: return KW_IS("double");
+        case 0x17c964c6eull: return KW_IS("else");
+        case 0x17c96553aull: return KW_IS("enum");
+        case 0x652fc34e17bull: return KW_IS("extern");
+        case 0x310f71e19bull: return KW_IS("float");
+        case 0xb88738cull: return KW_IS("for");
+        case 0x17c97721eull: return KW_IS("goto");
+        case 0x597834ull: return KW_IS("if");
+        case 0xb888030ull: return KW_IS("int");
+        case 0x17c9a2f35ull: return KW_IS("long");
+        case 0x1ae77e07ae7e8aull: return KW_IS("register");
+        case 0x65319306425ull: return KW_IS("return");
+        case 0x31105af0d5ull: return KW_IS("short");
+        case 0x6531bc6ae5full: return KW_IS("signed");
+        case 0x6531bd0f495ull: return KW_IS("sizeof");
+        case 0x6531c8a8badull: return KW_IS("static");
+        case 0x6531c93e1aaull: return KW_IS("struct");
+        case 0x6531cc53777ull: return KW_IS("switch");
+        case 0xd0b707872a76ull: return KW_IS("typedef");
+        case 0x311082522eull: return KW_IS("union");
+        case 0x1ae79e9d375962ull: return KW_IS("unsigned");
+        case 0x17c9faa57ull: return KW_IS("void");
+        case 0x1ae7a8c5959725ull: return KW_IS("volatile");
+        case 0x3110a3387eull: return KW_IS("while");
+        }
+
+        return 0;
+}
+
+
+/* perfect hash */
+/* every keyword fits in 8 bytes, so the zero padded first 8 bytes of the
+   token are the whole key. Multiplier was searched for offline so the 32
+   keywords land in different slots of a 64 entry table. */
+#define PERFECT_HASH_MUL 0x6495219df1f9ec3bull
+#define PERFECT_HASH_BITS 6
+
+uint64_t perfect_table[1 << PERFECT_HASH_BITS];
+
+static inline uint64_t
+load_word(const char *tok) {
+        uint64_t word;
+        memcpy(&word, tok, sizeof(word));
+        return word;
+}
+
+
+static inline uint64_t
+perfect_hash(uint64_t word) {
+        return (word * PERFECT_HASH_MUL) >> (64 - PERFECT_HASH_BITS);
+}
+
+
+void
+build_perfect_table() {
+        const char **kw_it = &keywords[0];
+
+        memset(perfect_table, 0, sizeof(perfect_table));
+        while(*kw_it) {
+                char tok[16] = {0};
+                memcpy(tok, *kw_it, strlen(*kw_it));
+
+                uint64_t word = load_word(tok);
+                uint64_t slot = perfect_hash(word);
+
+                if(perfect_table[slot] != 0) {
+                        printf("Perfect hash collision on %s\n", *kw_it);
+                        exit(1);
+                }
+
+                perfect_table[slot] = word;
+                ++kw_it;
+        }
+}
+
+
+static inline int
+is_keyword_perfect_hash(const char *tok, int len) {
+        uint64_t word = load_word(tok);
+        return (len <= 8) & (perfect_table[perfect_hash(word)] == word);
+}
+
+
+/* simd */
+/* keywords are packed two per 16 byte vector and bucketed by length, the
+   token is broadcast into both halves and compared against its bucket */
+__m128i simd_table[32];
+int simd_bucket_start[10];
+int simd_bucket_count[10];
+
+void
+build_simd_table() {
+        char packed[32][8] = {{0}};
+        int per_len[10] = {0};
+        int len, i, slot = 0;
+
+        for(len = 0; len < 10; ++len) {
+                simd_bucket_start[len] = slot;
+
+                int n = 0;
+                const char **kw_it = &keywords[0];
+                while(*kw_it) {
+                        if((int)strlen(*kw_it) == len) {
+                                memcpy(packed[slot * 2 + n], *kw_it, len);
+                                if(++n == 2) {
+                                        n = 0;
+                                        ++slot;
+                                }
+                        }
+                        ++kw_it;
+                }
+
+                /* odd bucket, other half stays zero and never matches */
+                if(n) {
+                        ++slot;
+                }
+
+                per_len[len] = slot - simd_bucket_start[len];
+        }
+
+        for(i = 0; i < slot; ++i) {
+                simd_table[i] = _mm_loadu_si128((__m128i*)packed[i * 2]);
+        }
+
+        for(len = 0; len < 10; ++len) {
+                simd_bucket_count[len] = per_len[len];
+        }
+}
+
+
+static inline int
+is_keyword_simd(const char *tok, int len) {
+        if(len > 8) {
+                return 0;
+        }
+
+        __m128i word = _mm_set1_epi64x((long long)load_word(tok));
+        int i = simd_bucket_start[len];
+        int end = i + simd_bucket_count[len];
+
+        for(; i < end; ++i) {
+                int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(word, simd_table[i]));
+                if((mask & 0xFF) == 0xFF || (mask & 0xFF00) == 0xFF00) {
+                        return 1;
+                }
+        }
+
+        return 0;
+}
+
+
+/* tokens/keywords found by the last run and how long it took */
+uint64_t token_count = 0;
+uint64_t keyword_count = 0;
+uint64_t elapsed_ns = 0;
+
+
+uint64_t
+bench_strcmp_chain(const char *text) {
+        char tok[16];
+        const char *it = text;
+        int len;
+        uint64_t tokens = 0;
+        uint64_t kws = 0;
+        uint64_t start_ns = get_time_ns();
+        uint64_t start = harness_start();
+
+        while((len = next_token(&it, tok)) >= 0) {
+                tokens += 1;
+                kws += len < 16 && is_keyword_strcmp(tok, len);
+        }
+
+        uint64_t end = harness_stop();
+
+        token_count = tokens;
+        keyword_count = kws;
+        elapsed_ns = get_time_ns() - start_ns;
+
+        return end - start;
+}
+
+
+uint64_t
+bench_len_switch(const char *text) {
+        char tok[16];
+        const char *it = text;
+        int len;
+        uint64_t tokens = 0;
+        uint64_t kws = 0;
+        uint64_t start_ns = get_time_ns();
+        uint64_t start = harness_start();
+
+        while((len = next_token(&it, tok)) >= 0) {
+                tokens += 1;
+                kws += is_keyword_len_switch(tok, len);
+        }
+
+        uint64_t end = harness_stop();
+
+        token_count = tokens;
+        keyword_count = kws;
+        elapsed_ns = get_time_ns() - start_ns;
+
+        return end - start;
+}
+
+
+uint64_t
+bench_hash_switch(const char *text) {
+        char tok[16];
+        const char *it = text;
+        int len;
+        uint64_t tokens = 0;
+        uint64_t kws = 0;
+        uint64_t start_ns = get_time_ns();
+        uint64_t start = harness_start();
+
+        while((len = next_token(&it, tok)) >= 0) {
+                tokens += 1;
+                kws += len < 16 && is_keyword_hash_switch(tok, len);
+        }
+
+        uint64_t end = harness_stop();
+
+        token_count = tokens;
+        keyword_count = kws;
+        elapsed_ns = get_time_ns() - start_ns;
+
+        return end - start;
+}
+
+
+uint64_t
+bench_perfect_hash(const char *text) {
+        char tok[16];
+        const char *it = text;
+        int len;
+        uint64_t tokens = 0;
+        uint64_t kws = 0;
+
+        build_perfect_table();
+
+        uint64_t start_ns = get_time_ns();
+        uint64_t start = harness_start();
+
+        while((len = next_token(&it, tok)) >= 0) {
+                tokens += 1;
+                kws += is_keyword_perfect_hash(tok, len);
+        }
+
+        uint64_t end = harness_stop();
+
+        token_count = tokens;
+        keyword_count = kws;
+        elapsed_ns = get_time_ns() - start_ns;
+
+        return end - start;
+}
+
+
+uint64_t
+bench_simd(const char *text) {
+        char tok[16];
+        const char *it = text;
+        int len;
+        uint64_t tokens = 0;
+        uint64_t kws = 0;
+
+        build_simd_table();
+
+        uint64_t start_ns = get_time_ns();
+        uint64_t start = harness_start();
+
+        while((len = next_token(&it, tok)) >= 0) {
+                tokens += 1;
+                kws += is_keyword_simd(tok, len);
+        }
+
+        uint64_t end = harness_stop();
+
+        token_count = tokens;
+        keyword_count = kws;
+        elapsed_ns = get_time_ns() - start_ns;
+
+        return end - start;
+}
+
+
+/* Benchmark */
+int
+main() {
+        char *text = generate_text(BENCH_TEXT_SIZE);
+        uint64_t (*bench)(const char*) = 0;
+        const char *name = "";
+
+        if(BENCH_TO_RUN == BENCH_STRCMP_CHAIN) {
+                bench = bench_strcmp_chain;
+                name = "strcmp chain";
+        }
+
+        if(BENCH_TO_RUN == BENCH_LEN_SWITCH) {
+                bench = bench_len_switch;
+                name = "len switch";
+        }
+
+        if(BENCH_TO_RUN == BENCH_HASH_SWITCH) {
+                bench = bench_hash_switch;
+                name = "hash switch";
+        }
+
+        if(BENCH_TO_RUN == BENCH_PERFECT_HASH) {
+                bench = bench_perfect_hash;
+                name = "perfect hash";
+        }
+
+        if(BENCH_TO_RUN == BENCH_SIMD) {
+                bench = bench_simd;
+                name = "simd";
+        }
+
+        struct harness cycles;
+        struct harness rate;
+        char inputs[64];
+        int i;
+
+        snprintf(inputs, sizeof(inputs), "%dKB %d%% keywords",
+                BENCH_TEXT_SIZE / 1024, BENCH_KEYWORD_PCT);
+
+        harness_begin(&cycles, "keywords", name, inputs, "cycles", 1);
+        harness_begin(&rate, "keywords", name, inputs, "tokens/sec", 0);
+        for(i = 0; i < BENCH_SAMPLES; ++i) {
+                harness_sample(&cycles, (double)bench(text));
+                harness_sample(&rate, (double)token_count * 1e9 /
+                        (double)elapsed_ns);
+        }
+        harness_report(&cycles);
+        harness_report(&rate);
+
+        printf("Tokens/Keywords: %llu %llu\n",
+                (unsigned long long)token_count,
+                (unsigned long long)keyword_count);
+        printf("Tokens/sec: %.0f\n", rate.max);
+        printf("%s: %llu\n--\n", name, (unsigned long long)cycles.min);
+
+        free(text);
+
+        return 0;
+}
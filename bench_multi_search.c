@@ -0,0 +1,468 @@
+/*
+ * Multi Pattern Search Benchmarks
+ * ===============================
+ *
+ * Finding any of a small set of words inside a long text, rather than
+ * whole string equality like bench_strcmp.c. Text is the strings from
+ * bench_strcmp.c picked at random and joined with spaces.
+ *
+ * - strstr once per pattern
+ * - Aho-Corasick compiled down to a full 256 wide DFA
+ * - Teddy, SSSE3 pshufb nibble masks as a prefilter then memcmp
+ * - Counts every (overlapping) occurrence of every pattern
+ * - Using RTDSC timer, GB/s from the monotonic clock
+ * - Runs through harness.h, printed numbers are the best sample
+ *
+ * Teddy puts each pattern in one of 8 buckets, the low and high nibble of
+ * each of the first 3 bytes index a 16 byte table of bucket bits, and the
+ * AND of those tables says which buckets might match at each position.
+ *
+ * Platforms
+ * ---------
+ *
+ * 1.
+ * Linux Debian 12 - Intel(R) Xeon(R) Processor
+ * gcc bench_multi_search.c -DBENCH_TO_RUN=BENCH_<TEST> -O3 (GCC 12.2.0)
+ *
+ * Results
+ * -------
+ *
+ * _Note:_ 8MB of text, 8 patterns
+ * _Note:_ GB/s
+ *
+ *  Platform | strstr | Aho-Corasick | Teddy
+ * ==========|========|==============|=======
+ *  1(GCC)   | 0.454  | 0.260        | 0.798
+ *
+ */
+
+#define BENCH_STRSTR 1
+#define BENCH_AHO_CORASICK 2
+#define BENCH_TEDDY 3
+
+
+#ifndef BENCH_TO_RUN
+#define BENCH_TO_RUN BENCH_STRSTR
+#endif
+
+/* size of the generated text in bytes */
+#ifndef BENCH_TEXT_SIZE
+#define BENCH_TEXT_SIZE (8 * 1024 * 1024)
+#endif
+
+/* each run scans the whole text, so fewer than the harness default */
+#ifndef BENCH_SAMPLES
+#define BENCH_SAMPLES 11
+#endif
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include <x86intrin.h>
+
+#include "harness.h"
+
+const char *strings[] = {
+        "a", "b", "c", "1", "2", "3", "abc", "123",
+        "if", "else if", "else", "break", "continue", "for", "while", "do",
+        "goto", "struct", "int", "float", "unsigned", "double", "char", "const",
+        "cpu", "gpu", "memory", "keyboard", "screen", "mouse", "template",
+        "compiler", "type", "class", "jaffa cake", "then", "reduce", "reuse",
+        "recycle", "black cats", "kiteboard", "surfboard", "skateboard",
+        "wakeboard", "wobbleboard", "breadboard",
+        "A really long string that takes up space",
+        "This is also a longer string that takes up space, time, and sugar",
+        "Everybody jump jump! Everybody jump jump jump jump jump jump!",
+        "Flowers with purple spots, bannanas and apples",
+        "The Quick Brown Fox Jumped Over The Lazy Dog",
+        "Lorim Ipsum",
+        "Foo", "Bar", "Baz", "Bin", "Fin", "Fab", "Boo", "Far", "FooBar",
+        "FooBoo", "BarBar", "Faz", "FinFar", "FabFin", "BazBoo", "BarFoo",
+        NULL
+};
+
+/* what we search for, needle is only at the very end of the text */
+const char *patterns[] = {
+        "Quick", "Fox", "Lazy", "jump", "purple", "sugar", "board", "needle",
+        NULL
+};
+
+/* xorshift, same sequence every run */
+uint64_t rand_state = 0x2545F4914F6CDD1Dull;
+
+uint64_t
+rand_next() {
+        rand_state ^= rand_state << 13;
+        rand_state ^= rand_state >> 7;
+        rand_state ^= rand_state << 17;
+        return rand_state;
+}
+
+
+char *
+generate_text(uint64_t size) {
+        char *text = malloc(size + 1);
+        const char *tail = " needle";
+        uint64_t tail_len = strlen(tail);
+        uint64_t count = 0;
+        uint64_t len = 0;
+
+        while(strings[count]) {
+                ++count;
+        }
+
+        while(1) {
+                const char *str = strings[rand_next() % count];
+                uint64_t str_len = strlen(str);
+
+                if(len + str_len + 1 + tail_len > size) {
+                        break;
+                }
+
+                memcpy(text + len, str, str_len);
+                len += str_len;
+                text[len++] = ' ';
+        }
+
+        memset(text + len, ' ', size - len - tail_len);
+        memcpy(text + size - tail_len, tail, tail_len);
+        text[size] = 0;
+
+        return text;
+}
+
+
+/* matches found by the last run and how long it took */
+uint64_t match_count = 0;
+uint64_t elapsed_ns = 0;
+
+
+/* strstr */
+uint64_t
+bench_strstr(const char *text, uint64_t size) {
+        const char **pat_it = &patterns[0];
+        uint64_t matches = 0;
+        uint64_t start_ns = get_time_ns();
+        uint64_t start = harness_start();
+
+        while(*pat_it) {
+                const char *it = text;
+                while((it = strstr(it, *pat_it))) {
+                        matches += 1;
+                        ++it;
+                }
+                ++pat_it;
+        }
+
+        uint64_t end = harness_stop();
+
+        match_count = matches;
+        elapsed_ns = get_time_ns() - start_ns;
+
+        return end - start;
+}
+
+
+/* Aho-Corasick */
+/* trie is built then every missing edge is filled from the failure link.
+   out is the number of patterns that end at a state, including through
+   failure links. The scan table packs the next state and its out count
+   into one entry so there is one load per byte. */
+#define AC_MAX_STATES 512
+
+int32_t ac_next[AC_MAX_STATES][256];
+int32_t ac_fail[AC_MAX_STATES];
+uint32_t ac_out[AC_MAX_STATES];
+uint32_t ac_dfa[AC_MAX_STATES * 256];
+int ac_state_count = 0;
+
+void
+build_aho_corasick() {
+        int queue[AC_MAX_STATES];
+        int head = 0, tail = 0;
+        int s, c;
+
+        memset(ac_next, -1, sizeof(ac_next));
+        memset(ac_out, 0, sizeof(ac_out));
+        ac_state_count = 1;
+
+        /* trie */
+        const char **pat_it = &patterns[0];
+        while(*pat_it) {
+                const uint8_t *p = (const uint8_t*)*pat_it;
+                s = 0;
+                while(*p) {
+                        if(ac_next[s][*p] < 0) {
+                                if(ac_state_count == AC_MAX_STATES) {
+                                        printf("Too many Aho-Corasick states\n");
+                                        exit(1);
+                                }
+                                ac_next[s][*p] = ac_state_count++;
+                        }
+                        s = ac_next[s][*p];
+                        ++p;
+                }
+                ac_out[s] += 1;
+                ++pat_it;
+        }
+
+        /* root edges */
+        ac_fail[0] = 0;
+        for(c = 0; c < 256; ++c) {
+                if(ac_next[0][c] < 0) {
+                        ac_next[0][c] = 0;
+                } else {
+                        ac_fail[ac_next[0][c]] = 0;
+                        queue[tail++] = ac_next[0][c];
+                }
+        }
+
+        /* breadth first, a state's failure is always done before it */
+        while(head < tail) {
+                s = queue[head++];
+                ac_out[s] += ac_out[ac_fail[s]];
+
+                for(c = 0; c < 256; ++c) {
+                        int t = ac_next[s][c];
+                        if(t < 0) {
+                                ac_next[s][c] = ac_next[ac_fail[s]][c];
+                        } else {
+                                ac_fail[t] = ac_next[ac_fail[s]][c];
+                                queue[tail++] = t;
+                        }
+                }
+        }
+
+        /* next state in the top 16 bits, out count in the bottom */
+        for(s = 0; s < ac_state_count; ++s) {
+                for(c = 0; c < 256; ++c) {
+                        int t = ac_next[s][c];
+                        ac_dfa[s * 256 + c] = ((uint32_t)t << 16) |
+                                (ac_out[t] & 0xFFFF);
+                }
+        }
+}
+
+
+uint64_t
+bench_aho_corasick(const char *text, uint64_t size) {
+        const uint8_t *p = (const uint8_t*)text;
+        const uint8_t *end_p = p + size;
+        uint64_t matches = 0;
+        uint32_t row = 0;
+
+        build_aho_corasick();
+
+        uint64_t start_ns = get_time_ns();
+        uint64_t start = harness_start();
+
+        while(p < end_p) {
+                uint32_t e = ac_dfa[row + *p++];
+                matches += e & 0xFFFF;
+                row = (e >> 16) << 8;
+        }
+
+        uint64_t end = harness_stop();
+
+        match_count = matches;
+        elapsed_ns = get_time_ns() - start_ns;
+
+        return end - start;
+}
+
+
+/* Teddy */
+#define TEDDY_BUCKETS 8
+#define TEDDY_MAX_FINGERPRINT 3
+#define TEDDY_MAX_PATTERNS 64
+
+__m128i teddy_lo[TEDDY_MAX_FINGERPRINT];
+__m128i teddy_hi[TEDDY_MAX_FINGERPRINT];
+int teddy_fingerprint = TEDDY_MAX_FINGERPRINT;
+
+/* patterns in each bucket, by index into patterns[] */
+int teddy_bucket[TEDDY_BUCKETS][TEDDY_MAX_PATTERNS];
+int teddy_bucket_count[TEDDY_BUCKETS];
+int teddy_pattern_len[TEDDY_MAX_PATTERNS];
+
+void
+build_teddy() {
+        uint8_t lo[TEDDY_MAX_FINGERPRINT][16] = {{0}};
+        uint8_t hi[TEDDY_MAX_FINGERPRINT][16] = {{0}};
+        int i, k;
+
+        memset(teddy_bucket_count, 0, sizeof(teddy_bucket_count));
+
+        for(i = 0; patterns[i]; ++i) {
+                int len = (int)strlen(patterns[i]);
+                if(i == TEDDY_MAX_PATTERNS) {
+                        printf("Too many Teddy patterns\n");
+                        exit(1);
+                }
+
+                teddy_pattern_len[i] = len;
+                if(len < teddy_fingerprint) {
+                        teddy_fingerprint = len;
+                }
+        }
+
+        for(i = 0; patterns[i]; ++i) {
+                const uint8_t *p = (const uint8_t*)patterns[i];
+                int b = i % TEDDY_BUCKETS;
+
+                teddy_bucket[b][teddy_bucket_count[b]++] = i;
+
+                for(k = 0; k < teddy_fingerprint; ++k) {
+                        lo[k][p[k] & 0xF] |= 1 << b;
+                        hi[k][p[k] >> 4] |= 1 << b;
+                }
+        }
+
+        for(k = 0; k < teddy_fingerprint; ++k) {
+                teddy_lo[k] = _mm_loadu_si128((__m128i*)lo[k]);
+                teddy_hi[k] = _mm_loadu_si128((__m128i*)hi[k]);
+        }
+}
+
+
+/* checks every pattern in the given buckets against text + pos */
+static inline uint64_t
+teddy_verify(
+        const char *text,
+        uint64_t size,
+        uint64_t pos,
+        uint32_t buckets)
+{
+        uint64_t matches = 0;
+
+        while(buckets) {
+                int b = __builtin_ctz(buckets);
+                int i;
+                buckets &= buckets - 1;
+
+                for(i = 0; i < teddy_bucket_count[b]; ++i) {
+                        int pat = teddy_bucket[b][i];
+                        int len = teddy_pattern_len[pat];
+
+                        if(pos + len <= size &&
+                           memcmp(text + pos, patterns[pat], len) == 0) {
+                                matches += 1;
+                        }
+                }
+        }
+
+        return matches;
+}
+
+
+__attribute__((target("ssse3")))
+uint64_t
+bench_teddy(const char *text, uint64_t size) {
+        const __m128i nibble = _mm_set1_epi8(0x0F);
+        const __m128i zero = _mm_setzero_si128();
+        uint64_t matches = 0;
+        uint64_t i = 0;
+        int k;
+
+        build_teddy();
+
+        uint64_t start_ns = get_time_ns();
+        uint64_t start = harness_start();
+
+        /* 16 positions at a time, each reads fingerprint - 1 bytes past */
+        while(i + 16 + teddy_fingerprint - 1 <= size) {
+                __m128i res = _mm_set1_epi8((char)0xFF);
+
+                for(k = 0; k < teddy_fingerprint; ++k) {
+                        __m128i v = _mm_loadu_si128((__m128i*)(text + i + k));
+                        __m128i lo = _mm_and_si128(v, nibble);
+                        __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), nibble);
+
+                        res = _mm_and_si128(res, _mm_and_si128(
+                                _mm_shuffle_epi8(teddy_lo[k], lo),
+                                _mm_shuffle_epi8(teddy_hi[k], hi)));
+                }
+
+                uint32_t cand = ~_mm_movemask_epi8(_mm_cmpeq_epi8(res, zero)) &
+                        0xFFFF;
+
+                if(cand) {
+                        uint8_t bits[16];
+                        _mm_storeu_si128((__m128i*)bits, res);
+
+                        while(cand) {
+                                int j = __builtin_ctz(cand);
+                                cand &= cand - 1;
+                                matches += teddy_verify(text, size, i + j,
+                                        bits[j]);
+                        }
+                }
+
+                i += 16;
+        }
+
+        /* tail, too short for a full load so check every bucket */
+        for(; i < size; ++i) {
+                matches += teddy_verify(text, size, i,
+                        (1 << TEDDY_BUCKETS) - 1);
+        }
+
+        uint64_t end = harness_stop();
+
+        match_count = matches;
+        elapsed_ns = get_time_ns() - start_ns;
+
+        return end - start;
+}
+
+
+/* Benchmark */
+int
+main() {
+        char *text = generate_text(BENCH_TEXT_SIZE);
+        uint64_t (*bench)(const char*, uint64_t) = 0;
+        const char *name = "";
+
+        if(BENCH_TO_RUN == BENCH_STRSTR) {
+                bench = bench_strstr;
+                name = "strstr";
+        }
+
+        if(BENCH_TO_RUN == BENCH_AHO_CORASICK) {
+                bench = bench_aho_corasick;
+                name = "aho-corasick";
+        }
+
+        if(BENCH_TO_RUN == BENCH_TEDDY) {
+                bench = bench_teddy;
+                name = "teddy";
+        }
+
+        struct harness cycles;
+        struct harness rate;
+        char inputs[64];
+        int i;
+
+        snprintf(inputs, sizeof(inputs), "%dKB text", BENCH_TEXT_SIZE / 1024);
+
+        harness_begin(&cycles, "multi_search", name, inputs, "cycles", 1);
+        harness_begin(&rate, "multi_search", name, inputs, "GB/s", 0);
+        for(i = 0; i < BENCH_SAMPLES; ++i) {
+                harness_sample(&cycles, (double)bench(text, BENCH_TEXT_SIZE));
+                harness_sample(&rate, (double)BENCH_TEXT_SIZE /
+                        (double)elapsed_ns);
+        }
+        harness_report(&cycles);
+        harness_report(&rate);
+
+        printf("Matches: %llu\n", (unsigned long long)match_count);
+        printf("GB/s: %.3f\n", rate.max);
+        printf("%s: %llu\n--\n", name, (unsigned long long)cycles.min);
+
+        free(text);
+
+        return 0;
+}
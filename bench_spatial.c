@@ -0,0 +1,835 @@
+/*
+ * Spatial Query Benchmarks
+ * ========================
+ *
+ * bench_err_check.c only checks that each env is well formed. The next
+ * thing anyone asks is which envs cover a point, or overlap a box. Quick
+ * bench of three ways to index millions of them.
+ *
+ * - Brute force SSE2 scan, coordinates in SoA, 4 boxes per compare
+ * - Uniform grid, a box goes in every cell it touches and is only counted
+ *   in the lowest cell it shares with the query
+ * - Packed R-tree bulk loaded with STR (sort tile recursive), 16 entries
+ *   per node in SoA, nodes scanned with the same SSE2 compare
+ * - Envs are validated first, same checks as bench_err_check plus nothing
+ *   below 0, BENCH_INVALID_PCT of them are broken
+ * - Point queries and square overlap queries, selectivity is the average
+ *   share of the valid boxes a query matches
+ * - Queries count matches, ids would cost each index 4 bytes per entry
+ * - Runs through harness.h, build ms (validate + index), bytes per box and
+ *   queries/sec, printed numbers are the best sample
+ *
+ * Platforms
+ * ---------
+ *
+ * 1.
+ * Linux Debian 12 - Intel(R) Xeon(R) Processor
+ * gcc bench_spatial.c -DBENCH_TO_RUN=BENCH_<TEST> -O3 (GCC 12.2.0)
+ *
+ * Results
+ * -------
+ *
+ * _Note:_ Boxes up to 4x4 in the 0..100 domain, 10% invalid, 256 queries
+ * _Note:_ Build ms, brackets are bytes per box
+ *
+ *  Platform | Boxes | scan       | grid        | rtree
+ * ==========|=======|============|=============|=============
+ *  1(GCC)   | 100k  | 0.8(16.0)  | 16.5(64.4)  | 3.9(17.3)
+ *  1(GCC)   | 1M    | 11.6(16.0) | 194.8(63.8) | 83.0(17.3)
+ *  1(GCC)   | 4M    | 58.2(16.0) | 748.6(63.8) | 565.4(17.3)
+ *
+ * _Note:_ Queries per second, selectivity is matches per valid box
+ *
+ *  Platform | Boxes | Query | Selectivity | scan  | grid    | rtree
+ * ==========|=======|=======|=============|=======|=========|=========
+ *  1(GCC)   | 100k  | point | 0.088%      | 7912  | 1397403 | 985927
+ *  1(GCC)   | 100k  | 2x2   | 0.248%      | 9595  | 524617  | 557501
+ *  1(GCC)   | 100k  | 10x10 | 1.703%      | 12022 | 94029   | 150800
+ *  1(GCC)   | 100k  | 40x40 | 18.755%     | 10851 | 12607   | 19784
+ *  1(GCC)   | 1M    | point | 0.088%      | 1006  | 263114  | 55675
+ *  1(GCC)   | 1M    | 2x2   | 0.247%      | 704   | 80616   | 37903
+ *  1(GCC)   | 1M    | 10x10 | 1.704%      | 698   | 10793   | 5995
+ *  1(GCC)   | 1M    | 40x40 | 18.743%     | 919   | 1042    | 674
+ *  1(GCC)   | 4M    | point | 0.088%      | 151   | 41113   | 12135
+ *  1(GCC)   | 4M    | 2x2   | 0.247%      | 149   | 14320   | 6119
+ *  1(GCC)   | 4M    | 10x10 | 1.703%      | 150   | 2352    | 1469
+ *  1(GCC)   | 4M    | 40x40 | 18.744%     | 148   | 216     | 161
+ *
+ * The domain is small so boxes pile up, a point query at 4M boxes still
+ * matches ~3000 of them. The grid wins on points, the R-tree on memory and
+ * build, the scan only once a query matches a big share of everything.
+ *
+ */
+
+#define BENCH_SCAN 1
+#define BENCH_GRID 2
+#define BENCH_RTREE 3
+
+
+#ifndef BENCH_TO_RUN
+#define BENCH_TO_RUN BENCH_SCAN
+#endif
+
+/* largest width and height of a generated box */
+#ifndef BENCH_BOX_SIZE
+#define BENCH_BOX_SIZE 4
+#endif
+
+/* percentage of generated envs that fail validation */
+#ifndef BENCH_INVALID_PCT
+#define BENCH_INVALID_PCT 10
+#endif
+
+/* queries per run */
+#ifndef BENCH_QUERIES
+#define BENCH_QUERIES 256
+#endif
+
+/* grid is BENCH_GRID_CELLS x BENCH_GRID_CELLS over the domain */
+#ifndef BENCH_GRID_CELLS
+#define BENCH_GRID_CELLS 32
+#endif
+
+/* each run is a full build or every query, so fewer than the default */
+#ifndef BENCH_SAMPLES
+#define BENCH_SAMPLES 5
+#endif
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <assert.h>
+#include <x86intrin.h>
+
+#include "harness.h"
+
+
+/* same as bench_err_check.c */
+/* top left corner must be less than bottom right corner */
+struct env {
+        int top_left_x, top_left_y;
+        int bot_right_x, bot_right_y;
+};
+
+#define DOMAIN_MAX 100
+
+/* entries per R-tree node, a multiple of 4 */
+#define NODE_SIZE 16
+
+/* padding, never overlaps anything */
+#define EMPTY_MIN (1 << 30)
+#define EMPTY_MAX (-(1 << 30))
+
+uint64_t box_counts[] = { 100000, 1000000, 4000000 };
+
+/* 0 is a point query */
+int query_sizes[] = { 0, 2, 10, 40 };
+
+
+/* xorshift, same sequence every run */
+uint64_t rand_state = 0x2545F4914F6CDD1Dull;
+
+uint64_t
+rand_next() {
+        rand_state ^= rand_state << 13;
+        rand_state ^= rand_state >> 7;
+        rand_state ^= rand_state << 17;
+        return rand_state;
+}
+
+
+/* inputs */
+void
+build_envs(struct env *envs, uint64_t count) {
+        uint64_t i;
+
+        rand_state = 0x2545F4914F6CDD1Dull;
+
+        for(i = 0; i < count; ++i) {
+                int w = (int)(rand_next() % (BENCH_BOX_SIZE + 1));
+                int h = (int)(rand_next() % (BENCH_BOX_SIZE + 1));
+                int x = (int)(rand_next() % (DOMAIN_MAX + 1 - w));
+                int y = (int)(rand_next() % (DOMAIN_MAX + 1 - h));
+                struct env e = { x, y, x + w, y + h };
+
+                if((int)(rand_next() % 100) < BENCH_INVALID_PCT) {
+                        switch(rand_next() % 4) {
+                        case 0: e.bot_right_x = e.top_left_x - 1 - w; break;
+                        case 1: e.bot_right_y = e.top_left_y - 1 - h; break;
+                        case 2: e.bot_right_x = 200; break;
+                        case 3: e.top_left_y = 300; break;
+                        }
+                }
+
+                envs[i] = e;
+        }
+}
+
+
+/* query boxes, a point is a box with no size */
+struct query {
+        int min_x, min_y, max_x, max_y;
+};
+
+struct query queries[BENCH_QUERIES];
+
+void
+build_queries(int size) {
+        int i;
+
+        rand_state = 0x9E3779B97F4A7C15ull;
+
+        for(i = 0; i < BENCH_QUERIES; ++i) {
+                int x = (int)(rand_next() % (DOMAIN_MAX + 1 - size));
+                int y = (int)(rand_next() % (DOMAIN_MAX + 1 - size));
+                queries[i].min_x = x;
+                queries[i].min_y = y;
+                queries[i].max_x = x + size;
+                queries[i].max_y = y + size;
+        }
+}
+
+
+/* boxes in SoA, min is the top left corner, max the bottom right */
+struct boxes {
+        int32_t *min_x, *min_y, *max_x, *max_y;
+        uint64_t count;
+};
+
+void
+boxes_alloc(struct boxes *b, uint64_t capacity) {
+        b->min_x = _mm_malloc(capacity * sizeof(int32_t), 16);
+        b->min_y = _mm_malloc(capacity * sizeof(int32_t), 16);
+        b->max_x = _mm_malloc(capacity * sizeof(int32_t), 16);
+        b->max_y = _mm_malloc(capacity * sizeof(int32_t), 16);
+        b->count = 0;
+}
+
+
+void
+boxes_free(struct boxes *b) {
+        _mm_free(b->min_x);
+        _mm_free(b->min_y);
+        _mm_free(b->max_x);
+        _mm_free(b->max_y);
+        memset(b, 0, sizeof(*b));
+}
+
+
+static inline void
+boxes_set(struct boxes *b, uint64_t i, int min_x, int min_y, int max_x,
+        int max_y)
+{
+        b->min_x[i] = min_x;
+        b->min_y[i] = min_y;
+        b->max_x[i] = max_x;
+        b->max_y[i] = max_y;
+}
+
+
+/* pads count up to a multiple, capacity has to allow for it */
+void
+boxes_pad(struct boxes *b, uint64_t multiple) {
+        while(b->count % multiple) {
+                boxes_set(b, b->count++, EMPTY_MIN, EMPTY_MIN, EMPTY_MAX,
+                        EMPTY_MAX);
+        }
+}
+
+
+/* validation */
+/* branch free like bench_error_table, every env is written and only the
+   valid ones move the end along */
+void
+validate(const struct env *envs, uint64_t count, struct boxes *out) {
+        uint64_t i;
+
+        out->count = 0;
+
+        for(i = 0; i < count; ++i) {
+                const struct env *e = &envs[i];
+                int err = 0;
+
+                err |= e->top_left_x > e->bot_right_x;
+                err |= e->top_left_y > e->bot_right_y;
+                err |= e->top_left_x > DOMAIN_MAX;
+                err |= e->bot_right_x > DOMAIN_MAX;
+                err |= e->top_left_y > DOMAIN_MAX;
+                err |= e->bot_right_y > DOMAIN_MAX;
+                err |= e->top_left_x < 0;
+                err |= e->top_left_y < 0;
+
+                boxes_set(out, out->count, e->top_left_x, e->top_left_y,
+                        e->bot_right_x, e->bot_right_y);
+                out->count += !err;
+        }
+}
+
+
+/* SSE2 overlap, one bit per box for the 4 boxes at i */
+struct query_4 {
+        __m128i min_x, min_y, max_x, max_y;
+};
+
+static inline struct query_4
+query_4(const struct query *q) {
+        struct query_4 q4;
+        q4.min_x = _mm_set1_epi32(q->min_x);
+        q4.min_y = _mm_set1_epi32(q->min_y);
+        q4.max_x = _mm_set1_epi32(q->max_x);
+        q4.max_y = _mm_set1_epi32(q->max_y);
+        return q4;
+}
+
+
+static inline int
+overlap_4(const struct boxes *b, uint64_t i, const struct query_4 *q) {
+        __m128i min_x = _mm_load_si128((const __m128i*)&b->min_x[i]);
+        __m128i min_y = _mm_load_si128((const __m128i*)&b->min_y[i]);
+        __m128i max_x = _mm_load_si128((const __m128i*)&b->max_x[i]);
+        __m128i max_y = _mm_load_si128((const __m128i*)&b->max_y[i]);
+
+        __m128i miss = _mm_or_si128(
+                _mm_or_si128(_mm_cmpgt_epi32(min_x, q->max_x),
+                        _mm_cmpgt_epi32(q->min_x, max_x)),
+                _mm_or_si128(_mm_cmpgt_epi32(min_y, q->max_y),
+                        _mm_cmpgt_epi32(q->min_y, max_y)));
+
+        return ~_mm_movemask_ps(_mm_castsi128_ps(miss)) & 0xF;
+}
+
+
+/* scan */
+struct boxes scan_boxes;
+
+uint64_t
+scan_build(const struct env *envs, uint64_t count) {
+        boxes_alloc(&scan_boxes, count + 4);
+        validate(envs, count, &scan_boxes);
+        boxes_pad(&scan_boxes, 4);
+
+        return scan_boxes.count * 4 * sizeof(int32_t);
+}
+
+
+uint64_t
+scan_query(const struct query *q) {
+        struct query_4 q4 = query_4(q);
+        uint64_t found = 0;
+        uint64_t i;
+
+        for(i = 0; i < scan_boxes.count; i += 4) {
+                found += __builtin_popcount(overlap_4(&scan_boxes, i, &q4));
+        }
+
+        return found;
+}
+
+
+void
+scan_free() {
+        boxes_free(&scan_boxes);
+}
+
+
+/* grid */
+/* cells are stored one after another, each padded to 4 entries. Each entry
+   keeps the lowest cell its box touches, a box is counted in the cell where
+   the query's and the box's lowest cells meet, so only once. */
+struct grid {
+        uint64_t start[BENCH_GRID_CELLS * BENCH_GRID_CELLS + 1];
+        struct boxes entries;
+        int32_t *first_x;
+        int32_t *first_y;
+};
+
+struct grid grid;
+
+static inline int
+grid_cell(int v) {
+        return v * BENCH_GRID_CELLS / (DOMAIN_MAX + 1);
+}
+
+
+uint64_t
+grid_build(const struct env *envs, uint64_t count) {
+        struct boxes valid;
+        uint64_t fill[BENCH_GRID_CELLS * BENCH_GRID_CELLS];
+        uint64_t i, total = 0;
+        int x, y, c;
+
+        boxes_alloc(&valid, count);
+        validate(envs, count, &valid);
+
+        memset(fill, 0, sizeof(fill));
+        for(i = 0; i < valid.count; ++i) {
+                for(y = grid_cell(valid.min_y[i]); y <= grid_cell(valid.max_y[i]); ++y) {
+                        for(x = grid_cell(valid.min_x[i]); x <= grid_cell(valid.max_x[i]); ++x) {
+                                fill[y * BENCH_GRID_CELLS + x] += 1;
+                        }
+                }
+        }
+
+        for(c = 0; c < BENCH_GRID_CELLS * BENCH_GRID_CELLS; ++c) {
+                grid.start[c] = total;
+                total += (fill[c] + 3) & ~3ull;
+                fill[c] = grid.start[c];
+        }
+        grid.start[c] = total;
+
+        boxes_alloc(&grid.entries, total);
+        grid.entries.count = total;
+        grid.first_x = _mm_malloc(total * sizeof(int32_t), 16);
+        grid.first_y = _mm_malloc(total * sizeof(int32_t), 16);
+
+        for(i = 0; i < valid.count; ++i) {
+                int first_x = grid_cell(valid.min_x[i]);
+                int first_y = grid_cell(valid.min_y[i]);
+
+                for(y = first_y; y <= grid_cell(valid.max_y[i]); ++y) {
+                        for(x = first_x; x <= grid_cell(valid.max_x[i]); ++x) {
+                                uint64_t at = fill[y * BENCH_GRID_CELLS + x]++;
+                                boxes_set(&grid.entries, at, valid.min_x[i],
+                                        valid.min_y[i], valid.max_x[i],
+                                        valid.max_y[i]);
+                                grid.first_x[at] = first_x;
+                                grid.first_y[at] = first_y;
+                        }
+                }
+        }
+
+        /* padding on the end of each cell */
+        for(c = 0; c < BENCH_GRID_CELLS * BENCH_GRID_CELLS; ++c) {
+                for(i = fill[c]; i < grid.start[c + 1]; ++i) {
+                        boxes_set(&grid.entries, i, EMPTY_MIN, EMPTY_MIN,
+                                EMPTY_MAX, EMPTY_MAX);
+                        grid.first_x[i] = -1;
+                        grid.first_y[i] = -1;
+                }
+        }
+
+        boxes_free(&valid);
+
+        return total * 6 * sizeof(int32_t) + sizeof(grid.start);
+}
+
+
+uint64_t
+grid_query(const struct query *q) {
+        struct query_4 q4 = query_4(q);
+        int first_x = grid_cell(q->min_x);
+        int first_y = grid_cell(q->min_y);
+        int last_x = grid_cell(q->max_x);
+        int last_y = grid_cell(q->max_y);
+        uint64_t found = 0;
+        int x, y;
+
+        for(y = first_y; y <= last_y; ++y) {
+                /* in the query's first row or column every box counts */
+                __m128i all_y = _mm_set1_epi32(y == first_y ? -1 : 0);
+                __m128i cell_y = _mm_set1_epi32(y);
+
+                for(x = first_x; x <= last_x; ++x) {
+                        __m128i all_x = _mm_set1_epi32(x == first_x ? -1 : 0);
+                        __m128i cell_x = _mm_set1_epi32(x);
+                        int c = y * BENCH_GRID_CELLS + x;
+                        uint64_t i;
+
+                        for(i = grid.start[c]; i < grid.start[c + 1]; i += 4) {
+                                __m128i own = _mm_and_si128(
+                                        _mm_or_si128(all_x, _mm_cmpeq_epi32(
+                                        _mm_load_si128((__m128i*)&grid.first_x[i]),
+                                        cell_x)),
+                                        _mm_or_si128(all_y, _mm_cmpeq_epi32(
+                                        _mm_load_si128((__m128i*)&grid.first_y[i]),
+                                        cell_y)));
+
+                                int hit = overlap_4(&grid.entries, i, &q4) &
+                                        _mm_movemask_ps(_mm_castsi128_ps(own));
+                                found += __builtin_popcount(hit);
+                        }
+                }
+        }
+
+        return found;
+}
+
+
+void
+grid_free() {
+        boxes_free(&grid.entries);
+        _mm_free(grid.first_x);
+        _mm_free(grid.first_y);
+}
+
+
+/* R-tree */
+/* levels[0] are the boxes, each level above has one entry per node of
+   NODE_SIZE entries below it, the MBR and where the node starts. The top
+   level fits in one node. */
+#define RTREE_MAX_LEVELS 16
+
+struct rtree {
+        struct boxes levels[RTREE_MAX_LEVELS];
+        uint32_t *child[RTREE_MAX_LEVELS];
+        int level_count;
+};
+
+struct rtree rtree;
+
+
+/* stable counting sort of order[0..n) on min + max, 0..2 * DOMAIN_MAX */
+void
+sort_by_center(uint32_t *order, uint32_t *tmp, uint64_t n, const int32_t *min,
+        const int32_t *max)
+{
+        uint64_t counts[DOMAIN_MAX * 2 + 2];
+        uint64_t i;
+
+        memset(counts, 0, sizeof(counts));
+        for(i = 0; i < n; ++i) {
+                counts[min[order[i]] + max[order[i]] + 1] += 1;
+        }
+        for(i = 1; i < DOMAIN_MAX * 2 + 2; ++i) {
+                counts[i] += counts[i - 1];
+        }
+        for(i = 0; i < n; ++i) {
+                uint32_t at = order[i];
+                tmp[counts[min[at] + max[at]]++] = at;
+        }
+
+        memcpy(order, tmp, n * sizeof(uint32_t));
+}
+
+
+/* STR order, slices of whole nodes sorted by x, then each slice by y */
+void
+str_order(const struct boxes *b, uint64_t n, uint32_t *order, uint32_t *tmp) {
+        uint64_t nodes = (n + NODE_SIZE - 1) / NODE_SIZE;
+        uint64_t slices = 1;
+        uint64_t i;
+
+        while(slices * slices < nodes) {
+                ++slices;
+        }
+
+        uint64_t slice_size = ((nodes + slices - 1) / slices) * NODE_SIZE;
+
+        for(i = 0; i < n; ++i) {
+                order[i] = (uint32_t)i;
+        }
+
+        sort_by_center(order, tmp, n, b->min_x, b->max_x);
+
+        for(i = 0; i < n; i += slice_size) {
+                uint64_t len = n - i < slice_size ? n - i : slice_size;
+                sort_by_center(order + i, tmp, len, b->min_y, b->max_y);
+        }
+}
+
+
+uint64_t
+rtree_build(const struct env *envs, uint64_t count) {
+        struct boxes valid;
+        uint64_t bytes = 0;
+        int l;
+
+        boxes_alloc(&valid, count);
+        validate(envs, count, &valid);
+
+        /* nothing valid, no levels and queries find nothing */
+        if(valid.count == 0) {
+                boxes_free(&valid);
+                rtree.level_count = 0;
+                return 0;
+        }
+
+        uint32_t *order = malloc((valid.count + 1) * sizeof(uint32_t));
+        uint32_t *tmp = malloc((valid.count + 1) * sizeof(uint32_t));
+
+        /* each pass packs src in STR order into level l, then makes the
+           entries for the level above from its nodes */
+        struct boxes src = valid;
+        uint32_t *src_child = 0;
+
+        for(l = 0; ; ++l) {
+                /* each level is NODE_SIZE times smaller than the one below */
+                assert(l < RTREE_MAX_LEVELS);
+
+                struct boxes *dst = &rtree.levels[l];
+                uint64_t n = src.count;
+                uint64_t i, node;
+
+                str_order(&src, n, order, tmp);
+
+                boxes_alloc(dst, n + NODE_SIZE);
+                rtree.child[l] = src_child ?
+                        _mm_malloc((n + NODE_SIZE) * sizeof(uint32_t), 16) : 0;
+
+                for(i = 0; i < n; ++i) {
+                        uint32_t at = order[i];
+                        boxes_set(dst, i, src.min_x[at], src.min_y[at],
+                                src.max_x[at], src.max_y[at]);
+                        if(src_child) {
+                                rtree.child[l][i] = src_child[at];
+                        }
+                }
+                dst->count = n;
+                boxes_pad(dst, NODE_SIZE);
+                for(i = n; src_child && i < dst->count; ++i) {
+                        rtree.child[l][i] = 0;
+                }
+
+                bytes += dst->count * (4 * sizeof(int32_t) +
+                        (src_child ? sizeof(uint32_t) : 0));
+
+                if(l > 0) {
+                        boxes_free(&src);
+                        free(src_child);
+                }
+
+                rtree.level_count = l + 1;
+                if(dst->count == NODE_SIZE) {
+                        break;
+                }
+
+                /* one entry per node for the level above */
+                uint64_t nodes = dst->count / NODE_SIZE;
+                boxes_alloc(&src, nodes);
+                src.count = nodes;
+                src_child = malloc(nodes * sizeof(uint32_t));
+
+                for(node = 0; node < nodes; ++node) {
+                        int min_x = EMPTY_MIN, min_y = EMPTY_MIN;
+                        int max_x = EMPTY_MAX, max_y = EMPTY_MAX;
+
+                        for(i = node * NODE_SIZE; i < (node + 1) * NODE_SIZE; ++i) {
+                                if(dst->min_x[i] == EMPTY_MIN) {
+                                        continue;
+                                }
+                                min_x = dst->min_x[i] < min_x ? dst->min_x[i] : min_x;
+                                min_y = dst->min_y[i] < min_y ? dst->min_y[i] : min_y;
+                                max_x = dst->max_x[i] > max_x ? dst->max_x[i] : max_x;
+                                max_y = dst->max_y[i] > max_y ? dst->max_y[i] : max_y;
+                        }
+
+                        boxes_set(&src, node, min_x, min_y, max_x, max_y);
+                        src_child[node] = (uint32_t)(node * NODE_SIZE);
+                }
+        }
+
+        boxes_free(&valid);
+        free(order);
+        free(tmp);
+
+        return bytes;
+}
+
+
+uint64_t
+rtree_query(const struct query *q) {
+        struct query_4 q4 = query_4(q);
+        /* level and first entry of each node still to look at */
+        struct { int level; uint32_t start; } stack[RTREE_MAX_LEVELS * NODE_SIZE];
+        int top = 0;
+        uint64_t found = 0;
+
+        if(rtree.level_count == 0) {
+                return 0;
+        }
+
+        stack[top].level = rtree.level_count - 1;
+        stack[top].start = 0;
+        ++top;
+
+        while(top) {
+                --top;
+                int level = stack[top].level;
+                uint32_t start = stack[top].start;
+                const struct boxes *b = &rtree.levels[level];
+                uint32_t i;
+
+                if(level == 0) {
+                        for(i = start; i < start + NODE_SIZE; i += 4) {
+                                found += __builtin_popcount(overlap_4(b, i, &q4));
+                        }
+                        continue;
+                }
+
+                for(i = start; i < start + NODE_SIZE; i += 4) {
+                        int hit = overlap_4(b, i, &q4);
+                        while(hit) {
+                                int lane = __builtin_ctz(hit);
+                                hit &= hit - 1;
+                                stack[top].level = level - 1;
+                                stack[top].start = rtree.child[level][i + lane];
+                                ++top;
+                        }
+                }
+        }
+
+        return found;
+}
+
+
+void
+rtree_free() {
+        int l;
+
+        for(l = 0; l < rtree.level_count; ++l) {
+                boxes_free(&rtree.levels[l]);
+                _mm_free(rtree.child[l]);
+                rtree.child[l] = 0;
+        }
+        rtree.level_count = 0;
+}
+
+
+/* Benchmark */
+/* results of the last run */
+uint64_t valid_count = 0;
+uint64_t match_count = 0;
+uint64_t index_bytes = 0;
+
+uint64_t (*index_build)(const struct env*, uint64_t) = 0;
+uint64_t (*index_query)(const struct query*) = 0;
+void (*index_free)() = 0;
+
+
+/* validates and indexes, returns ns */
+double
+bench_build(const struct env *envs, uint64_t count) {
+        uint64_t start_ns = get_time_ns();
+        harness_start();
+
+        index_bytes = index_build(envs, count);
+
+        harness_stop();
+        return (double)(get_time_ns() - start_ns);
+}
+
+
+/* every query, returns queries/sec */
+double
+bench_queries() {
+        uint64_t found = 0;
+        int i;
+
+        uint64_t start_ns = get_time_ns();
+        harness_start();
+
+        for(i = 0; i < BENCH_QUERIES; ++i) {
+                found += index_query(&queries[i]);
+        }
+
+        harness_stop();
+        uint64_t ns = get_time_ns() - start_ns;
+
+        match_count = found;
+
+        return (double)BENCH_QUERIES * 1e9 / (double)ns;
+}
+
+
+int
+main() {
+        const char *name = "";
+        int c, q, i;
+
+        if(BENCH_TO_RUN == BENCH_SCAN) {
+                index_build = scan_build;
+                index_query = scan_query;
+                index_free = scan_free;
+                name = "scan";
+        }
+
+        if(BENCH_TO_RUN == BENCH_GRID) {
+                index_build = grid_build;
+                index_query = grid_query;
+                index_free = grid_free;
+                name = "grid";
+        }
+
+        if(BENCH_TO_RUN == BENCH_RTREE) {
+                index_build = rtree_build;
+                index_query = rtree_query;
+                index_free = rtree_free;
+                name = "rtree";
+        }
+
+        for(c = 0; c < (int)(sizeof(box_counts) / sizeof(box_counts[0])); ++c) {
+                uint64_t count = box_counts[c];
+                struct env *envs = malloc(count * sizeof(struct env));
+                struct boxes valid;
+                struct harness build, memory;
+                char inputs[64];
+
+                build_envs(envs, count);
+
+                boxes_alloc(&valid, count);
+                validate(envs, count, &valid);
+                valid_count = valid.count;
+                boxes_free(&valid);
+
+                snprintf(inputs, sizeof(inputs), "%lluk boxes",
+                        (unsigned long long)(count / 1000));
+
+                harness_begin(&build, "spatial", name, inputs, "build ms", 1);
+                for(i = 0; i < BENCH_SAMPLES; ++i) {
+                        if(i > 0) {
+                                index_free();
+                        }
+                        harness_sample(&build, bench_build(envs, count) / 1e6);
+                }
+                harness_report(&build);
+
+                harness_begin(&memory, "spatial", name, inputs, "bytes/box", 1);
+                harness_sample(&memory, valid_count ?
+                        (double)index_bytes / valid_count : 0.0);
+                harness_report(&memory);
+
+                printf("Boxes/Valid: %llu %llu\n", (unsigned long long)count,
+                        (unsigned long long)valid_count);
+                printf("%s %s: %.1f build ms, %.1f bytes/box\n", name, inputs,
+                        build.min, memory.min);
+
+                for(q = 0; q < (int)(sizeof(query_sizes) / sizeof(query_sizes[0])); ++q) {
+                        struct harness h;
+                        char query_inputs[96];
+
+                        build_queries(query_sizes[q]);
+
+                        if(query_sizes[q]) {
+                                snprintf(query_inputs, sizeof(query_inputs),
+                                        "%s %dx%d", inputs, query_sizes[q],
+                                        query_sizes[q]);
+                        } else {
+                                snprintf(query_inputs, sizeof(query_inputs),
+                                        "%s point", inputs);
+                        }
+
+                        harness_begin(&h, "spatial", name, query_inputs,
+                                "queries/sec", 0);
+                        for(i = 0; i < BENCH_SAMPLES; ++i) {
+                                harness_sample(&h, bench_queries());
+                        }
+                        harness_report(&h);
+
+                        printf("Matches: %llu, selectivity %.3f%%\n",
+                                (unsigned long long)match_count,
+                                valid_count ? 100.0 * match_count /
+                                ((double)BENCH_QUERIES * valid_count) : 0.0);
+                        printf("%s %s: %.0f queries/sec\n", name,
+                                query_inputs, h.max);
+                }
+
+                printf("--\n");
+
+                index_free();
+                free(envs);
+        }
+
+        return 0;
+}
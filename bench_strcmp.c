@@ -3,8 +3,22 @@
  * ============================
  *
  * - Various strcmp methods
+ * - Case insensitive methods, needle is searched for as "NeEdLe"
  * - Using RTDSC timer
+ * - Runs through harness.h, printed time is the fastest sample
  * - -msse didn't show any diff on platforms 1 and 2
+ * - SSE2 compares read up to 15 bytes past the terminator, never over a
+ *   page boundary
+ * - BENCH_SWEEP=1 repeats the strings out to past LLC size, needle still
+ *   last, BENCH_CACHE=cold flushes them before each run, see harness.h
+ * - Near misses puts "need" in front of every other string, so first byte
+ *   and prefix checks always pass. BENCH_INPUTS=last|near|utf8 picks at
+ *   run time, make pgo uses it to run a trained build on both
+ * - UTF-8 mixed case puts "Ωμεγα Café " in front of every string and looks
+ *   for "ωμεγα café needle", as "ΩΜΕΓΑ CAFÉ NeEdLe" when case insensitive.
+ *   Only utf8 folds Latin-1 and Greek, the ASCII folds find nothing
+ * - -DBENCH_LATENCY records each compare into a histogram, the one that
+ *   finds the needle isn't counted, see harness.h
  * 
  * Platforms
  * ---------
@@ -22,6 +36,10 @@
  * gcc bench_strcmp.c -DBENCH_TO_RUN=BENCH_<TEST> -O3 (GCC 5.4.0)
  * clang bench_strcmp.c -DBENCH_TO_RUN=BENCH_<TEST> -O3 (Clang 7.0.0)
  *
+ * 4.
+ * Linux Debian 12 - Intel(R) Xeon(R) Processor
+ * gcc bench_strcmp.c -DBENCH_TO_RUN=BENCH_<TEST> -O3 (GCC 12.2.0)
+ *
  * Results
  * -------
  *
@@ -33,6 +51,28 @@
  *  2(Clang) | 32715  | 475                | 2640         | 243
  *  3(GCC)   | 4666   | 2151               | 12923        | 542
  *  3(Clang) | 4592   | 1994               | 13449        | 509
+ *  4(GCC)   | 9366   | 7184               | 16688        | 904
+ *
+ * Case Insensitive Results
+ * ------------------------
+ *
+ * _Note:_ Picked best times
+ * _Note:_ utf8 is the validating compare, corpus is all ASCII
+ * _Note:_ utf8 on the UTF-8 mixed case inputs is in its own table below
+ *
+ *  Platform | strcasecmp | simd fold | hash fold runtime | utf8
+ * ==========|============|===========|===================|======
+ *  4(GCC)   | 21308      | 8362      | 21030             | 11014
+ *
+ * UTF-8 Mixed Case Results
+ * ------------------------
+ *
+ * _Note:_ Picked best times, BENCH_INPUTS=utf8
+ * _Note:_ The ASCII folds don't find the needle, so scan everything
+ *
+ *  Platform | strcasecmp | simd fold | hash fold runtime | utf8
+ * ==========|============|===========|===================|======
+ *  4(GCC)   | 4370       | 3478      | 29770             | 48560
  *
  */
 
@@ -40,19 +80,35 @@
 #define BENCH_STRCMP_PREFIX 2
 #define BENCH_HASH_RT 3
 #define BENCH_HASH_AT 4
+#define BENCH_STRCASECMP 5
+#define BENCH_STRCASECMP_SIMD 6
+#define BENCH_HASH_FOLD_RT 7
+#define BENCH_UTF8_CASECMP 8
+
+
+#define BENCH_NEEDLE_LAST 1
+#define BENCH_NEAR_MISSES 2
+#define BENCH_UTF8_MIXED_CASE 3
 
 
 #ifndef BENCH_TO_RUN
 #define BENCH_TO_RUN BENCH_STRCMP
 #endif
 
+#ifndef BENCH_INPUTS
+#define BENCH_INPUTS BENCH_NEEDLE_LAST
+#endif
+
 
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include <strings.h>
 #include <stdio.h>
 #include <x86intrin.h>
 
+#include "harness.h"
+
 const char *strings[] = {
         "a", "b", "c", "1", "2", "3", "abc", "123",
         "if", "else if", "else", "break", "continue", "for", "while", "do",
@@ -151,6 +207,34 @@ const char *strings[] = {
 };
 
 const char *search_for = "needle";
+const char *search_for_case = "NeEdLe";
+
+uint64_t strings_count = (sizeof(strings) / sizeof(strings[0])) - 1;
+
+/* strings[] with a prefix in front, needle still last */
+const char *prefixed[sizeof(strings) / sizeof(strings[0])];
+
+
+/* the needle becomes needle, or the prefix and needle if it's set */
+void
+build_prefixed(const char *prefix, const char *needle) {
+        uint64_t i;
+
+        for(i = 0; i < strings_count; ++i) {
+                char *str = malloc(strlen(prefix) + strlen(strings[i]) + 1);
+
+                if(strcmp(strings[i], search_for) == 0) {
+                        strcpy(str, needle ? needle : strings[i]);
+                } else {
+                        strcpy(str, prefix);
+                        strcat(str, strings[i]);
+                }
+
+                prefixed[i] = str;
+        }
+
+        prefixed[strings_count] = NULL;
+}
 
 uint64_t
 hash_str(const char *str) {
@@ -164,28 +248,46 @@ hash_str(const char *str) {
 }
 
 
+/* same as hash_str but A-Z hash the same as a-z */
+static inline uint8_t
+fold_ascii(uint8_t c) {
+        return c | ((uint8_t)(c - 'A') < 26) << 5;
+}
+
+
 uint64_t
-get_time_rdtsc() {
-        return __builtin_ia32_rdtsc();  
+hash_str_fold(const char *str) {
+        uint64_t hash = 5381;
+        int c;
+        while(c = fold_ascii(*str++), c) {
+          hash = ((hash << 5) + hash) + c;
+        }
+
+        return hash;
 }
 
 
+/* string found by the last run */
+const char *found_str = 0;
+
+
 /* A basic string compare function */
 uint64_t
-bench_strcmp() {
-        const char **str_it = &strings[0];
-        uint64_t start = get_time_rdtsc();
+bench_strcmp(const char **strs, uint64_t count) {
+        const char **str_it = &strs[0];
+        uint64_t start = harness_start();
 
         while(*str_it) {
           if(strcmp(*str_it, search_for) == 0) {
             break;
           }
           ++str_it;
+          HARNESS_OP();
         }
 
-        uint64_t end = get_time_rdtsc();
+        uint64_t end = harness_stop();
 
-        printf("Found %s\n", *str_it);
+        found_str = *str_it;
 
         return end - start;
 }
@@ -200,14 +302,15 @@ pre_check(uint8_t *a, uint8_t *b) {
 
 
 uint64_t
-bench_strcmp_prefix() {
-        const char **str_it = &strings[0];
-        uint64_t start = get_time_rdtsc();
+bench_strcmp_prefix(const char **strs, uint64_t count) {
+        const char **str_it = &strs[0];
+        uint64_t start = harness_start();
 
         uint8_t *search_int = (uint8_t*)search_for;
 
+        /* op ends at the loop test, the prefix check skips the body end */
         const char *str;
-        while(str = *str_it++, str) {
+        while(HARNESS_OP(), str = *str_it++, str) {
                   /* check prefix first */
                   if(!pre_check((uint8_t*)*str_it, search_int)) {
                           continue;
@@ -219,9 +322,9 @@ bench_strcmp_prefix() {
                 }
         }
 
-        uint64_t end = get_time_rdtsc();
+        uint64_t end = harness_stop();
 
-        printf("Found %s\n", *str_it);
+        found_str = *str_it;
 
         return end - start;
 }
@@ -229,9 +332,9 @@ bench_strcmp_prefix() {
 
 /* hashing strings as we go */
 uint64_t
-bench_hash_rt() {
-        const char **str_it = &strings[0];
-        uint64_t start = get_time_rdtsc();
+bench_hash_rt(const char **strs, uint64_t count) {
+        const char **str_it = &strs[0];
+        uint64_t start = harness_start();
         uint64_t search_hash = hash_str(search_for);
 
         while(*str_it) {
@@ -240,11 +343,12 @@ bench_hash_rt() {
                         break;
                 }
                 ++str_it;
+          HARNESS_OP();
         }
 
-        uint64_t end = get_time_rdtsc();
+        uint64_t end = harness_stop();
         
-        printf("Found %s\n", *str_it);
+        found_str = *str_it;
         
         return end - start;
 }
@@ -252,25 +356,32 @@ bench_hash_rt() {
 
 /* hashing everything ahead of time */
 uint64_t
-bench_hash_at() {
-        /* build hash table */
-        uint64_t hash_arr[(sizeof(strings) / sizeof(strings[0]))];
-        int count = (sizeof(strings) / sizeof(strings[0]));
-        int i;
+bench_hash_at(const char **strs, uint64_t count) {
+        /* build hash table, kept between runs as the sweep makes it big */
+        static uint64_t *hash_arr = 0;
+        static uint64_t hash_capacity = 0;
+        uint64_t i;
+
+        if(count + 1 > hash_capacity) {
+                hash_capacity = count + 1;
+                hash_arr = realloc(hash_arr, hash_capacity * sizeof(uint64_t));
+        }
+
         for(i = 0; i < count; ++i) {
-                if(strings[i] == NULL) {
-                        hash_arr[i] = (uint64_t)-1;
-                }
-                else {
-                        hash_arr[i] = hash_str(strings[i]);
-                }
+                hash_arr[i] = hash_str(strs[i]);
+        }
+        hash_arr[count] = (uint64_t)-1;
+
+        /* the table is what gets searched, so it's what has to be cold */
+        if(harness_cold()) {
+                harness_flush(hash_arr, (count + 1) * sizeof(uint64_t));
         }
 
         /* search */
         uint64_t *hash_it = &hash_arr[0];
         uint64_t search_hash = hash_str(search_for);
 
-        uint64_t start = get_time_rdtsc();
+        uint64_t start = harness_start();
         
         while(*hash_it != (uint64_t)-1) {
                 if(*hash_it == search_hash) {
@@ -278,34 +389,489 @@ bench_hash_at() {
                 }
 
                 ++hash_it;
+                HARNESS_OP();
         }
 
-        uint64_t end = get_time_rdtsc();
+        uint64_t end = harness_stop();
         
-        printf("Found %s\n", strings[hash_it - &hash_arr[0]]);
+        found_str = strs[hash_it - &hash_arr[0]];
         
         return end - start;
 }
 
 
+/* libc case insensitive compare */
+uint64_t
+bench_strcasecmp(const char **strs, uint64_t count) {
+        const char **str_it = &strs[0];
+        uint64_t start = harness_start();
+
+        while(*str_it) {
+          if(strcasecmp(*str_it, search_for_case) == 0) {
+            break;
+          }
+          ++str_it;
+          HARNESS_OP();
+        }
+
+        uint64_t end = harness_stop();
+
+        found_str = *str_it;
+
+        return end - start;
+}
+
+
+/* SSE2 case insensitive equality, 16 bytes at a time. Lanes in A-Z get
+   0x20 or'd in, bytes >= 0x80 are negative so never fold. Loads can read
+   past the terminator but never over a page boundary. */
+#define PAGE_CROSS_16(p) ((((uintptr_t)(p)) & 4095) > 4096 - 16)
+
+static inline __m128i
+fold_ascii_16(__m128i v) {
+        __m128i upper = _mm_and_si128(
+                _mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)),
+                _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+        return _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+
+/* returns the block result, or -1 if the strings carry on past it */
+static inline int
+casecmp_block_16(__m128i va, __m128i vb) {
+        uint32_t ne = ~_mm_movemask_epi8(_mm_cmpeq_epi8(fold_ascii_16(va),
+                fold_ascii_16(vb))) & 0xFFFF;
+        uint32_t z = _mm_movemask_epi8(_mm_cmpeq_epi8(va,
+                _mm_setzero_si128()));
+
+        if(!(ne | z)) {
+                return -1;
+        }
+
+        /* equal if the first stop is both strings ending */
+        return !((ne >> __builtin_ctz(ne | z)) & 1);
+}
+
+
+int
+strcasecmp_eq_simd(const char *a, const char *b) {
+        while(1) {
+                if(PAGE_CROSS_16(a) || PAGE_CROSS_16(b)) {
+                        uint8_t ca = fold_ascii(*a++);
+                        uint8_t cb = fold_ascii(*b++);
+                        if(ca != cb) {
+                                return 0;
+                        }
+                        if(!ca) {
+                                return 1;
+                        }
+                        continue;
+                }
+
+                int res = casecmp_block_16(_mm_loadu_si128((__m128i*)a),
+                        _mm_loadu_si128((__m128i*)b));
+                if(res >= 0) {
+                        return res;
+                }
+
+                a += 16;
+                b += 16;
+        }
+}
+
+
+uint64_t
+bench_strcasecmp_simd(const char **strs, uint64_t count) {
+        const char **str_it = &strs[0];
+        uint64_t start = harness_start();
+
+        while(*str_it) {
+          if(strcasecmp_eq_simd(*str_it, search_for_case)) {
+            break;
+          }
+          ++str_it;
+          HARNESS_OP();
+        }
+
+        uint64_t end = harness_stop();
+
+        found_str = *str_it;
+
+        return end - start;
+}
+
+
+/* hashing strings as we go, folding case in the hash */
+uint64_t
+bench_hash_fold_rt(const char **strs, uint64_t count) {
+        const char **str_it = &strs[0];
+        uint64_t start = harness_start();
+        uint64_t search_hash = hash_str_fold(search_for_case);
+
+        while(*str_it) {
+                uint64_t hash = hash_str_fold(*str_it);
+                if(hash == search_hash) {
+                        break;
+                }
+                ++str_it;
+          HARNESS_OP();
+        }
+
+        uint64_t end = harness_stop();
+
+        found_str = *str_it;
+
+        return end - start;
+}
+
+
+/* UTF-8 validating case insensitive compare */
+/* ASCII, Latin-1 and basic Greek fold, anything else has to match byte for
+   byte. Invalid UTF-8 in either string never matches. Blocks of 16 ASCII
+   bytes skip validation and go through the SSE2 path above. */
+
+/* length of the valid sequence at p, 0 if invalid */
+static inline int
+utf8_seq_len(const uint8_t *p) {
+        uint8_t c = p[0];
+
+        if(c < 0x80) {
+                return 1;
+        }
+
+        if(c >= 0xC2 && c <= 0xDF) {
+                return (p[1] & 0xC0) == 0x80 ? 2 : 0;
+        }
+
+        if(c >= 0xE0 && c <= 0xEF) {
+                uint8_t lo = c == 0xE0 ? 0xA0 : 0x80;
+                uint8_t hi = c == 0xED ? 0x9F : 0xBF;
+                if(p[1] < lo || p[1] > hi || (p[2] & 0xC0) != 0x80) {
+                        return 0;
+                }
+                return 3;
+        }
+
+        if(c >= 0xF0 && c <= 0xF4) {
+                uint8_t lo = c == 0xF0 ? 0x90 : 0x80;
+                uint8_t hi = c == 0xF4 ? 0x8F : 0xBF;
+                if(p[1] < lo || p[1] > hi || (p[2] & 0xC0) != 0x80 ||
+                   (p[3] & 0xC0) != 0x80) {
+                        return 0;
+                }
+                return 4;
+        }
+
+        return 0;
+}
+
+
+/* lower case of a 2 byte sequence's code point, À-Þ and Α-Ω are 0x20 below
+   their lower case, except × and the gap at U+03A2 */
+static inline uint32_t
+utf8_fold_2(const uint8_t *p) {
+        uint32_t cp = ((uint32_t)(p[0] & 0x1F) << 6) | (p[1] & 0x3F);
+
+        if((cp >= 0xC0 && cp <= 0xDE && cp != 0xD7) ||
+           (cp >= 0x391 && cp <= 0x3A9 && cp != 0x3A2)) {
+                return cp + 0x20;
+        }
+
+        return cp;
+}
+
+
+int
+utf8_casecmp_eq(const char *a, const char *b) {
+        const uint8_t *pa = (const uint8_t*)a;
+        const uint8_t *pb = (const uint8_t*)b;
+
+        while(1) {
+                if(!PAGE_CROSS_16(pa) && !PAGE_CROSS_16(pb)) {
+                        __m128i va = _mm_loadu_si128((__m128i*)pa);
+                        __m128i vb = _mm_loadu_si128((__m128i*)pb);
+
+                        /* all ASCII in both */
+                        if(!_mm_movemask_epi8(_mm_or_si128(va, vb))) {
+                                int res = casecmp_block_16(va, vb);
+                                if(res >= 0) {
+                                        return res;
+                                }
+
+                                pa += 16;
+                                pb += 16;
+                                continue;
+                        }
+                }
+
+                /* one sequence at a time until the next block */
+                const uint8_t *block_end = pa + 16;
+                while(pa < block_end) {
+                        if(*pa < 0x80) {
+                                uint8_t ca = fold_ascii(*pa++);
+                                uint8_t cb = fold_ascii(*pb++);
+                                if(ca != cb) {
+                                        return 0;
+                                }
+                                if(!ca) {
+                                        return 1;
+                                }
+                                continue;
+                        }
+
+                        int len = utf8_seq_len(pa);
+                        if(!len || utf8_seq_len(pb) != len) {
+                                return 0;
+                        }
+
+                        if(len == 2 ? utf8_fold_2(pa) != utf8_fold_2(pb) :
+                           memcmp(pa, pb, len) != 0) {
+                                return 0;
+                        }
+
+                        pa += len;
+                        pb += len;
+                }
+        }
+}
+
+
+uint64_t
+bench_utf8_casecmp(const char **strs, uint64_t count) {
+        const char **str_it = &strs[0];
+        uint64_t start = harness_start();
+
+        while(*str_it) {
+          if(utf8_casecmp_eq(*str_it, search_for_case)) {
+            break;
+          }
+          ++str_it;
+          HARNESS_OP();
+        }
+
+        uint64_t end = harness_stop();
+
+        found_str = *str_it;
+
+        return end - start;
+}
+
+
+/* working set */
+/* the working set's strings, all in one block */
+char *arena = 0;
+uint64_t arena_size = 0;
+
+
+/* copies of source without the needle, then the needle, filling about
+   bytes with pointers and characters */
+const char **
+build_working_set(
+        const char **source,
+        uint64_t source_count,
+        uint64_t bytes,
+        uint64_t *count)
+{
+        uint64_t needle_size = strlen(search_for) + 1 + sizeof(char*);
+        uint64_t used = sizeof(char*); /* the NULL on the end */
+        uint64_t i, n = 0;
+
+        /* shortest string is 2 bytes, so never more than this */
+        const char **strs = malloc((bytes / (sizeof(char*) + 2) + 2) *
+                sizeof(char*));
+        char *it = arena = malloc(bytes + 16);
+
+        for(i = 0; ; i = (i + 1) % source_count) {
+                const char *src = source[i];
+                uint64_t len = strlen(src) + 1;
+
+                if(strcmp(src, search_for) == 0) {
+                        continue;
+                }
+
+                if(used + len + sizeof(char*) + needle_size > bytes) {
+                        break;
+                }
+
+                memcpy(it, src, len);
+                strs[n++] = it;
+                it += len;
+                used += len + sizeof(char*);
+        }
+
+        strcpy(it, search_for);
+        strs[n++] = it;
+        strs[n] = NULL;
+
+        arena_size = it + strlen(search_for) + 1 - arena;
+
+        *count = n;
+        return strs;
+}
+
+
+/* flushes the array and every string in it */
+void
+flush_strings(const char **strs, uint64_t count) {
+        uint64_t i;
+
+        harness_flush(strs, (count + 1) * sizeof(char*));
+
+        if(arena) {
+                harness_flush(arena, arena_size);
+                return;
+        }
+
+        for(i = 0; i < count; ++i) {
+                harness_flush(strs[i], strlen(strs[i]) + 1);
+        }
+}
+
+
+/* runs one set of strings through the harness, per string when sweeping */
+double
+run_samples(
+        uint64_t (*bench)(const char**, uint64_t),
+        const char *name,
+        const char **strs,
+        uint64_t count,
+        const char *inputs_name,
+        int per_string)
+{
+        struct harness h;
+        int cold = harness_cold();
+        char full_name[HARNESS_NAME_MAX + sizeof(" cold")];
+        int i;
+
+        snprintf(full_name, sizeof(full_name), "%s%s", inputs_name,
+                cold ? " cold" : "");
+
+        harness_begin(&h, "strcmp", name, full_name,
+                per_string ? "cycles/string" : "cycles", 1);
+        for(i = 0; i < BENCH_SAMPLES; ++i) {
+                if(cold) {
+                        flush_strings(strs, count);
+                }
+
+                double cycles = (double)bench(strs, count);
+                harness_sample(&h, per_string ? cycles / count : cycles);
+        }
+        harness_report(&h);
+
+        return h.min;
+}
+
+
 /* Benchmark */
 int
 main() {
+        uint64_t (*bench)(const char**, uint64_t) = 0;
+        const char *name = "";
+
         if(BENCH_TO_RUN == BENCH_STRCMP) {
-                printf("strcmp: %llu\n--\n", bench_strcmp());
+                bench = bench_strcmp;
+                name = "strcmp";
         }
 
         if(BENCH_TO_RUN == BENCH_STRCMP_PREFIX) {
-                printf("strcmp with prefix: %llu\n--\n", bench_strcmp_prefix());
+                bench = bench_strcmp_prefix;
+                name = "strcmp with prefix";
         }
 
         if(BENCH_TO_RUN == BENCH_HASH_RT) {
-                printf("hash rt: %llu\n--\n", bench_hash_rt());
+                bench = bench_hash_rt;
+                name = "hash rt";
         }
 
         if(BENCH_TO_RUN == BENCH_HASH_AT) {
-                printf("hash at: %llu\n--\n", bench_hash_at());
+                bench = bench_hash_at;
+                name = "hash at";
+        }
+
+        if(BENCH_TO_RUN == BENCH_STRCASECMP) {
+                bench = bench_strcasecmp;
+                name = "strcasecmp";
+        }
+
+        if(BENCH_TO_RUN == BENCH_STRCASECMP_SIMD) {
+                bench = bench_strcasecmp_simd;
+                name = "strcasecmp simd";
+        }
+
+        if(BENCH_TO_RUN == BENCH_HASH_FOLD_RT) {
+                bench = bench_hash_fold_rt;
+                name = "hash fold rt";
+        }
+
+        if(BENCH_TO_RUN == BENCH_UTF8_CASECMP) {
+                bench = bench_utf8_casecmp;
+                name = "utf8 casecmp";
+        }
+
+        /* inputs */
+        const char **source = 0;
+        const char *inputs_name = "";
+        const char *pick = harness_inputs(
+                BENCH_INPUTS == BENCH_NEAR_MISSES ? "near" :
+                BENCH_INPUTS == BENCH_UTF8_MIXED_CASE ? "utf8" : "last");
+
+        if(strcmp(pick, "last") == 0) {
+                source = strings;
+                inputs_name = "needle last";
+        } else if(strcmp(pick, "near") == 0) {
+                build_prefixed("need", 0);
+                source = prefixed;
+                inputs_name = "near misses";
+        } else if(strcmp(pick, "utf8") == 0) {
+                build_prefixed("Ωμεγα Café ", "ωμεγα café needle");
+                search_for = "ωμεγα café needle";
+                search_for_case = "ΩΜΕΓΑ CAFÉ NeEdLe";
+                source = prefixed;
+                inputs_name = "utf8 mixed case";
+        } else {
+                fprintf(stderr, "Unknown inputs %s, last, near or utf8\n",
+                        pick);
+                return 1;
         }
 
+        if(!harness_sweep()) {
+                double best = run_samples(bench, name, source, strings_count,
+                        inputs_name, 0);
+
+                printf("Found %s\n", found_str ? found_str : "nothing");
+                printf("%s: %llu\n--\n", name, (unsigned long long)best);
+
+                return 0;
+        }
+
+        uint64_t sizes[HARNESS_SWEEP_MAX];
+        int size_count = harness_sweep_sizes(sizes, HARNESS_SWEEP_MAX);
+        char found[64] = "nothing";
+        int s;
+
+        for(s = 0; s < size_count; ++s) {
+                uint64_t count;
+                const char **strs = build_working_set(source, strings_count,
+                        sizes[s], &count);
+                char size_name[32], set_name[HARNESS_NAME_MAX];
+
+                snprintf(set_name, sizeof(set_name), "%s %s", inputs_name,
+                        harness_size_name(sizes[s], size_name,
+                        sizeof(size_name)));
+
+                double best = run_samples(bench, name, strs, count, set_name, 1);
+
+                printf("%s %s: %.3f cycles/string\n", name, set_name, best);
+
+                /* found_str points into the arena */
+                snprintf(found, sizeof(found), "%s",
+                        found_str ? found_str : "nothing");
+                free(strs);
+                free(arena);
+                arena = 0;
+        }
+
+        printf("Found %s\n--\n", found);
+
         return 0;
 }
@@ -0,0 +1,1094 @@
+/*
+ * Benchmark Harness
+ * =================
+ *
+ * Shared by the bench_*.c files. Runs each kernel BENCH_SAMPLES times and
+ * writes one machine readable record per metric, so results don't have to
+ * be copied out of the terminal by hand.
+ *
+ * - Kernels time themselves with harness_start() / harness_stop(), which
+ *   also turn hardware counters on and off around the timed region
+ * - Records are JSON lines by default, BENCH_FORMAT=csv for CSV
+ * - Records go to stdout, or are appended to the file in BENCH_RESULTS
+ * - Compiler flags come from -DBENCH_FLAGS="..." if the build passes them
+ * - BENCH_INPUTS=name overrides the inputs the suite was built with
+ * - Counters use perf_event_open on Linux, they are null if it isn't
+ *   available (eg. perf_event_paranoid, VMs, MacOSX)
+ *
+ * Isolation
+ * ---------
+ *
+ * A 300 cycle loop is easily thrown off by the process moving cores, the
+ * clock ramping up or a context switch half way through. On Linux:
+ *
+ * - BENCH_CPU=n pins the process to core n before the first sample
+ * - BENCH_FIFO=1 also runs it SCHED_FIFO (needs root or CAP_SYS_NICE)
+ * - Warns on stderr when the cpufreq governor isn't performance or
+ *   turbo is on, either one makes the first samples slower than the rest
+ * - Samples whose harness_start() / harness_stop() region saw a context
+ *   switch (getrusage) are outliers. They are left out of the stats and
+ *   counted in the record, BENCH_OUTLIERS=keep keeps them in. If every
+ *   sample was an outlier they are all kept
+ *
+ * Suites that run their own threads define HARNESS_NO_PIN before including
+ * this, or every thread would end up on the one core.
+ *
+ * Caches
+ * ------
+ *
+ * Small inputs sit in L1 after the first sample, so suites that support it
+ * have two more modes:
+ *
+ * - BENCH_SWEEP=1 grows the inputs from L1 size to BENCH_SWEEP_LLC (4)
+ *   times the last level cache, doubling, and reports cycles/element
+ * - BENCH_CACHE=cold clflushes the inputs before every timed run, inputs
+ *   bigger than the LLC are evicted by walking a buffer twice its size
+ *   instead, as that is ~10x quicker than a clflush per line
+ * - Cache sizes come from cpuid, which leaf (or the 32KB/8MB defaults) is
+ *   printed on stderr
+ *
+ * Compare two result files with results.c.
+ *
+ * Latency
+ * -------
+ *
+ * Built with -DBENCH_LATENCY, kernels put HARNESS_OP() after each lookup or
+ * check and the harness keeps a log bucketed histogram (HDR style, 16 sub
+ * buckets per power of two, ~6%) of the cycles between them. Each sample's
+ * p50/p90/p99/p99.9 become extra records, unit "cycles/op p99" etc.
+ *
+ * - One rdtsc per op, no fences, so about 20-40 cycles go on every op.
+ *   -DBENCH_LATENCY_BATCH=n only takes a timestamp every n ops, units
+ *   become cycles/batch
+ * - The cost of an empty op is recorded as "cycles/op timer", and the
+ *   usual cycles record of a latency build against a plain one shows how
+ *   much the instrumentation moved the whole loop, see make latency
+ * - Without BENCH_LATENCY HARNESS_OP() is nothing
+ *
+ * Record
+ * ------
+ *
+ * {"suite":"strcmp","variant":"strcmp","inputs":"default",
+ *  "unit":"cycles","better":"lower","compiler":"GCC 12.2.0",
+ *  "flags":"-O3","cpu":"Intel(R) ...","host":"box","count":31,
+ *  "min":..,"median":..,"mean":..,"stddev":..,"max":..,"outliers":0,
+ *  "counters":{"instructions":..,"branches":..,"branch_misses":..},
+ *  "samples":[..]}
+ *
+ * Counters are the median over the samples.
+ */
+
+#ifndef HARNESS_H
+#define HARNESS_H
+
+/* times each kernel is run */
+#ifndef BENCH_SAMPLES
+#define BENCH_SAMPLES 31
+#endif
+
+/* room for a variant or inputs name, eg. "4MB mixed cold" */
+#define HARNESS_NAME_MAX 128
+
+/* flags the file was built with, passed in by the build */
+#ifndef BENCH_FLAGS
+#define BENCH_FLAGS "unknown"
+#endif
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <cpuid.h>
+#include <x86intrin.h>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sys/resource.h>
+#include <linux/perf_event.h>
+
+/* Linux only, and glibc hides it without _GNU_SOURCE */
+#ifndef RUSAGE_THREAD
+#define RUSAGE_THREAD 1
+#endif
+#endif
+
+
+#if defined(__clang__)
+#define HARNESS_COMPILER "Clang " __clang_version__
+#elif defined(__GNUC__)
+#define HARNESS_COMPILER "GCC " __VERSION__
+#else
+#define HARNESS_COMPILER "unknown"
+#endif
+
+
+static inline uint64_t
+get_time_rdtsc() {
+        return __builtin_ia32_rdtsc();
+}
+
+
+static inline uint64_t
+get_time_ns() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+
+/* counters */
+#define HARNESS_COUNTER_COUNT 3
+
+static const char *harness_counter_names[HARNESS_COUNTER_COUNT] = {
+        "instructions", "branches", "branch_misses",
+};
+
+/* -1 not tried yet, -2 not available */
+static int harness_perf_fd = -1;
+
+/* values from the last harness_start() / harness_stop() pair */
+static uint64_t harness_counter_values[HARNESS_COUNTER_COUNT];
+static int harness_counter_valid = 0;
+
+
+static void
+harness_counters_open() {
+#ifdef __linux__
+        static const uint64_t configs[HARNESS_COUNTER_COUNT] = {
+                PERF_COUNT_HW_INSTRUCTIONS,
+                PERF_COUNT_HW_BRANCH_INSTRUCTIONS,
+                PERF_COUNT_HW_BRANCH_MISSES,
+        };
+        int i;
+
+        harness_perf_fd = -2;
+
+        for(i = 0; i < HARNESS_COUNTER_COUNT; ++i) {
+                struct perf_event_attr attr;
+                memset(&attr, 0, sizeof(attr));
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.size = sizeof(attr);
+                attr.config = configs[i];
+                attr.disabled = i == 0;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_GROUP;
+
+                int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1,
+                        i == 0 ? -1 : harness_perf_fd, 0);
+
+                if(fd < 0) {
+                        /* all or nothing, leader going closes the group */
+                        if(harness_perf_fd >= 0) {
+                                close(harness_perf_fd);
+                        }
+                        harness_perf_fd = -2;
+                        return;
+                }
+
+                if(i == 0) {
+                        harness_perf_fd = fd;
+                }
+        }
+#else
+        harness_perf_fd = -2;
+#endif
+}
+
+
+/* latency */
+#ifdef BENCH_LATENCY
+
+#ifndef BENCH_LATENCY_BATCH
+#define BENCH_LATENCY_BATCH 1
+#endif
+
+/* values below 32 get a bucket each, then 16 per power of two */
+#define HARNESS_HIST_SUB 16
+#define HARNESS_HIST_SIZE (HARNESS_HIST_SUB * 2 + 59 * HARNESS_HIST_SUB)
+#define HARNESS_PCT_COUNT 4
+
+static const double harness_pcts[HARNESS_PCT_COUNT] = {
+        50.0, 90.0, 99.0, 99.9,
+};
+
+static const char *harness_pct_names[HARNESS_PCT_COUNT] = {
+        "p50", "p90", "p99", "p99.9",
+};
+
+static uint64_t harness_hist[HARNESS_HIST_SIZE];
+static uint64_t harness_hist_count = 0;
+static uint64_t harness_op_last = 0;
+static int harness_op_n = 0;
+
+
+static inline int
+harness_hist_index(uint64_t v) {
+        if(v < HARNESS_HIST_SUB * 2) {
+                return (int)v;
+        }
+
+        int e = 63 - __builtin_clzll(v);
+        return HARNESS_HIST_SUB * 2 + (e - 5) * HARNESS_HIST_SUB +
+                (int)((v >> (e - 4)) & (HARNESS_HIST_SUB - 1));
+}
+
+
+/* highest value that lands in the bucket */
+static uint64_t
+harness_hist_value(int index) {
+        if(index < HARNESS_HIST_SUB * 2) {
+                return index;
+        }
+
+        int e = (index - HARNESS_HIST_SUB * 2) / HARNESS_HIST_SUB + 5;
+        uint64_t sub = (index - HARNESS_HIST_SUB * 2) % HARNESS_HIST_SUB;
+        uint64_t low = (HARNESS_HIST_SUB + sub) << (e - 4);
+
+        return low + (1ull << (e - 4)) - 1;
+}
+
+
+static uint64_t
+harness_hist_percentile(double pct) {
+        uint64_t want = (uint64_t)(harness_hist_count * pct / 100.0 + 0.5);
+        uint64_t seen = 0;
+        int i;
+
+        if(want == 0) {
+                want = 1;
+        }
+
+        for(i = 0; i < HARNESS_HIST_SIZE; ++i) {
+                seen += harness_hist[i];
+                if(seen >= want) {
+                        return harness_hist_value(i);
+                }
+        }
+
+        return 0;
+}
+
+
+static void
+harness_hist_clear() {
+        memset(harness_hist, 0, sizeof(harness_hist));
+        harness_hist_count = 0;
+}
+
+
+/* end of one op, or of one batch of them */
+static inline void
+harness_op() {
+        if(++harness_op_n == BENCH_LATENCY_BATCH) {
+                uint64_t now = get_time_rdtsc();
+                harness_hist[harness_hist_index(now - harness_op_last)] += 1;
+                harness_hist_count += 1;
+                harness_op_last = now;
+                harness_op_n = 0;
+        }
+}
+
+
+#define HARNESS_OP() harness_op()
+
+
+/* cycles one empty op costs, best of a few tries */
+static double
+harness_op_overhead() {
+        double best = 0.0;
+        int i, j;
+
+        for(j = 0; j < 5; ++j) {
+                uint64_t start = get_time_rdtsc();
+                harness_op_last = start;
+                harness_op_n = 0;
+
+                for(i = 0; i < 1000 * BENCH_LATENCY_BATCH; ++i) {
+                        harness_op();
+                }
+
+                double cost = (double)(get_time_rdtsc() - start) /
+                        (1000.0 * BENCH_LATENCY_BATCH);
+                if(j == 0 || cost < best) {
+                        best = cost;
+                }
+        }
+
+        harness_hist_clear();
+
+        return best;
+}
+
+#else
+#define HARNESS_OP() ((void)0)
+#endif
+
+
+/* isolation */
+/* context switches at harness_start(), and if the last run saw any. Set once
+   per run so every metric sampled from that run is dropped together. */
+static long harness_switches_start = 0;
+static int harness_switched = 0;
+
+
+static inline long
+harness_switches() {
+#ifdef __linux__
+        struct rusage ru;
+
+        if(getrusage(RUSAGE_THREAD, &ru) == 0) {
+                return ru.ru_nvcsw + ru.ru_nivcsw;
+        }
+#endif
+
+        return 0;
+}
+
+
+#ifdef __linux__
+/* first line of a sysfs file, 0 if it isn't there */
+static int
+harness_read_sys(const char *path, char *buf, int size) {
+        FILE *f = fopen(path, "r");
+        int ok;
+
+        if(!f) {
+                return 0;
+        }
+
+        ok = fgets(buf, size, f) != NULL;
+        fclose(f);
+
+        if(ok) {
+                buf[strcspn(buf, "\n")] = 0;
+        }
+
+        return ok;
+}
+#endif
+
+
+/* pins, raises priority and checks the clock, once per process */
+static void
+harness_isolate() {
+#ifdef __linux__
+        static int done = 0;
+        const char *env;
+        char path[128], buf[64];
+        long cpu = -1;
+
+        if(done) {
+                return;
+        }
+        done = 1;
+
+#ifndef HARNESS_NO_PIN
+        env = getenv("BENCH_CPU");
+        if(env && env[0]) {
+                /* raw syscall, cpu_set_t needs _GNU_SOURCE before any include */
+                unsigned long mask[16];
+                cpu = strtol(env, NULL, 10);
+
+                memset(mask, 0, sizeof(mask));
+                if(cpu >= 0 && cpu < (long)(sizeof(mask) * 8)) {
+                        mask[cpu / (sizeof(long) * 8)] |=
+                                1ul << (cpu % (sizeof(long) * 8));
+                }
+
+                if(syscall(SYS_sched_setaffinity, 0, sizeof(mask), mask) != 0) {
+                        fprintf(stderr, "harness: can't pin to cpu %ld\n", cpu);
+                        cpu = -1;
+                }
+        }
+#endif
+
+        env = getenv("BENCH_FIFO");
+        if(env && env[0] && env[0] != '0') {
+                struct sched_param param;
+                memset(&param, 0, sizeof(param));
+
+                /* one below max, so the kernel's own fifo threads still run */
+                param.sched_priority = sched_get_priority_max(SCHED_FIFO) - 1;
+
+                if(sched_setscheduler(0, SCHED_FIFO, &param) != 0) {
+                        fprintf(stderr, "harness: can't set SCHED_FIFO\n");
+                }
+        }
+
+        /* the governor of the core we run on, or cpu0 if not pinned */
+        snprintf(path, sizeof(path),
+                "/sys/devices/system/cpu/cpu%ld/cpufreq/scaling_governor",
+                cpu < 0 ? 0 : cpu);
+        if(harness_read_sys(path, buf, sizeof(buf)) &&
+           strcmp(buf, "performance") != 0) {
+                fprintf(stderr, "harness: cpufreq governor is %s, "
+                        "not performance\n", buf);
+        }
+
+        if(harness_read_sys("/sys/devices/system/cpu/intel_pstate/no_turbo",
+                buf, sizeof(buf)) && strcmp(buf, "0") == 0) {
+                fprintf(stderr, "harness: turbo is on\n");
+        } else if(harness_read_sys("/sys/devices/system/cpu/cpufreq/boost",
+                buf, sizeof(buf)) && strcmp(buf, "1") == 0) {
+                fprintf(stderr, "harness: boost is on\n");
+        }
+#endif
+}
+
+
+/* call right before and after the timed region, returns the rdtsc time */
+static inline uint64_t
+harness_start() {
+        harness_switches_start = harness_switches();
+        harness_switched = 0;
+
+#ifdef __linux__
+        if(harness_perf_fd >= 0) {
+                ioctl(harness_perf_fd, PERF_EVENT_IOC_RESET,
+                        PERF_IOC_FLAG_GROUP);
+                ioctl(harness_perf_fd, PERF_EVENT_IOC_ENABLE,
+                        PERF_IOC_FLAG_GROUP);
+        }
+#endif
+
+#ifdef BENCH_LATENCY
+        harness_op_n = 0;
+        harness_op_last = get_time_rdtsc();
+        return harness_op_last;
+#else
+        return get_time_rdtsc();
+#endif
+}
+
+
+static inline uint64_t
+harness_stop() {
+        uint64_t end = get_time_rdtsc();
+
+#ifdef __linux__
+        if(harness_perf_fd >= 0) {
+                uint64_t buf[1 + HARNESS_COUNTER_COUNT];
+
+                ioctl(harness_perf_fd, PERF_EVENT_IOC_DISABLE,
+                        PERF_IOC_FLAG_GROUP);
+
+                if(read(harness_perf_fd, buf, sizeof(buf)) == sizeof(buf)) {
+                        memcpy(harness_counter_values, &buf[1],
+                                sizeof(harness_counter_values));
+                        harness_counter_valid = 1;
+                }
+        }
+#endif
+
+        if(harness_switches() != harness_switches_start) {
+                harness_switched = 1;
+        }
+
+        return end;
+}
+
+
+/* system info */
+static const char *
+harness_cpu() {
+        static char brand[49];
+        unsigned int regs[12];
+        unsigned int i;
+
+        if(brand[0]) {
+                return brand;
+        }
+
+        if(__get_cpuid_max(0x80000000, 0) < 0x80000004) {
+                strcpy(brand, "unknown");
+                return brand;
+        }
+
+        for(i = 0; i < 3; ++i) {
+                __get_cpuid(0x80000002 + i, &regs[i * 4], &regs[i * 4 + 1],
+                        &regs[i * 4 + 2], &regs[i * 4 + 3]);
+        }
+
+        memcpy(brand, regs, 48);
+        brand[48] = 0;
+
+        /* some brand strings are right aligned */
+        char *start = brand;
+        while(*start == ' ') {
+                ++start;
+        }
+        memmove(brand, start, strlen(start) + 1);
+
+        return brand;
+}
+
+
+static const char *
+harness_host() {
+        static char host[256];
+
+        if(!host[0] && gethostname(host, sizeof(host) - 1) != 0) {
+                strcpy(host, "unknown");
+        }
+
+        return host;
+}
+
+
+/* inputs */
+/* BENCH_INPUTS=name picks the inputs at run time, so one build (eg. a
+   PGO one) can be run on several, otherwise it's the build's default */
+static inline const char *
+harness_inputs(const char *fallback) {
+        const char *env = getenv("BENCH_INPUTS");
+        return env && env[0] ? env : fallback;
+}
+
+
+/* caches */
+#define HARNESS_SWEEP_MAX 32
+
+/* walks a cpuid cache leaf, returns how many data caches it listed */
+static int
+harness_cache_leaf(unsigned int leaf, uint64_t *l1, uint64_t *llc) {
+        unsigned int a, b, c, d;
+        int i, found = 0;
+
+        for(i = 0; i < 16; ++i) {
+                __cpuid_count(leaf, i, a, b, c, d);
+
+                unsigned int type = a & 31;
+                unsigned int level = (a >> 5) & 7;
+                uint64_t size = (uint64_t)(((b >> 22) & 0x3FF) + 1) *
+                        (((b >> 12) & 0x3FF) + 1) * ((b & 0xFFF) + 1) * (c + 1);
+
+                /* 0 is the end of the list, 2 is instruction only */
+                if(type == 0) {
+                        break;
+                }
+                if(type == 2) {
+                        continue;
+                }
+
+                if(level == 1) {
+                        *l1 = size;
+                }
+                *llc = size;
+                found += 1;
+        }
+
+        return found;
+}
+
+
+/* L1 data and last level sizes from cpuid leaf 4, AMD leaves that empty and
+   lists its caches in 0x8000001D. Says which on stderr the first time. */
+static void
+harness_cache_sizes(uint64_t *l1, uint64_t *llc) {
+        static int logged = 0;
+        const char *source = "defaults";
+
+        *l1 = 32 * 1024;
+        *llc = 8 * 1024 * 1024;
+
+        if(__get_cpuid_max(0, 0) >= 4 && harness_cache_leaf(4, l1, llc)) {
+                source = "cpuid 4";
+        } else if(__get_cpuid_max(0x80000000, 0) >= 0x8000001D &&
+                harness_cache_leaf(0x8000001D, l1, llc)) {
+                source = "cpuid 0x8000001D";
+        }
+
+        if(!logged) {
+                fprintf(stderr, "harness: caches from %s, L1d %lluKB, "
+                        "LLC %lluKB\n", source,
+                        (unsigned long long)(*l1 / 1024),
+                        (unsigned long long)(*llc / 1024));
+                logged = 1;
+        }
+}
+
+
+static inline int
+harness_sweep() {
+        const char *env = getenv("BENCH_SWEEP");
+        return env && env[0] && env[0] != '0';
+}
+
+
+static inline int
+harness_cold() {
+        const char *env = getenv("BENCH_CACHE");
+        return env && strcmp(env, "cold") == 0;
+}
+
+
+/* working set sizes in bytes for the sweep, returns the count */
+static inline int
+harness_sweep_sizes(uint64_t *sizes, int max) {
+        const char *env = getenv("BENCH_SWEEP_LLC");
+        uint64_t l1, llc, size, limit;
+        int count = 0;
+
+        harness_cache_sizes(&l1, &llc);
+        limit = llc * (env && atoi(env) > 0 ? atoi(env) : 4);
+
+        for(size = l1; size < limit && count < max - 1; size *= 2) {
+                sizes[count++] = size;
+        }
+        sizes[count++] = limit;
+
+        return count;
+}
+
+
+/* eg. 32KB, 2MB */
+static inline const char *
+harness_size_name(uint64_t bytes, char *buf, int size) {
+        if(bytes >= 1024 * 1024 && bytes % (1024 * 1024) == 0) {
+                snprintf(buf, size, "%lluMB",
+                        (unsigned long long)(bytes / (1024 * 1024)));
+        } else if(bytes >= 1024 && bytes % 1024 == 0) {
+                snprintf(buf, size, "%lluKB", (unsigned long long)(bytes / 1024));
+        } else {
+                snprintf(buf, size, "%lluB", (unsigned long long)bytes);
+        }
+
+        return buf;
+}
+
+
+/* pulls [p, p + bytes) out of every cache level */
+static inline void
+harness_flush(const void *p, uint64_t bytes) {
+        static volatile uint8_t *evict = 0;
+        static uint64_t evict_size = 0;
+        const char *it = (const char*)((uintptr_t)p & ~(uintptr_t)63);
+        const char *end = (const char*)p + bytes;
+
+        if(!evict_size) {
+                uint64_t l1;
+                harness_cache_sizes(&l1, &evict_size);
+                evict_size *= 2;
+        }
+
+        if(bytes > evict_size / 2) {
+                uint64_t i;
+                uint8_t sum = 0;
+
+                if(!evict) {
+                        evict = malloc(evict_size);
+                        memset((void*)evict, 1, evict_size);
+                }
+
+                for(i = 0; i < evict_size; i += 64) {
+                        sum += evict[i];
+                }
+                evict[0] = sum;
+
+                return;
+        }
+
+        for(; it < end; it += 64) {
+                _mm_clflush(it);
+        }
+
+        _mm_mfence();
+}
+
+
+/* results */
+struct harness {
+        const char *suite;
+        const char *variant;
+        const char *inputs;
+        const char *unit;
+        int lower_is_better;
+
+        double samples[BENCH_SAMPLES];
+        uint64_t counters[BENCH_SAMPLES][HARNESS_COUNTER_COUNT];
+        int counter_count;
+        int count;
+
+        /* samples that saw a context switch, and counters that go with them */
+        double outliers[BENCH_SAMPLES];
+        uint64_t outlier_counters[BENCH_SAMPLES][HARNESS_COUNTER_COUNT];
+        int outlier_counter_count;
+        int outlier_count;
+        int keep_outliers;
+
+#ifdef BENCH_LATENCY
+        /* percentiles of each sample, and what an empty op costs */
+        double latency[HARNESS_PCT_COUNT][BENCH_SAMPLES];
+        int latency_count;
+        double op_overhead;
+#endif
+
+        /* filled in by harness_report */
+        double min, median, mean, stddev, max;
+};
+
+
+static void
+harness_begin(
+        struct harness *h,
+        const char *suite,
+        const char *variant,
+        const char *inputs,
+        const char *unit,
+        int lower_is_better)
+{
+        memset(h, 0, sizeof(*h));
+        h->suite = suite;
+        h->variant = variant;
+        h->inputs = inputs;
+        h->unit = unit;
+        h->lower_is_better = lower_is_better;
+
+        const char *keep = getenv("BENCH_OUTLIERS");
+        h->keep_outliers = keep && strcmp(keep, "keep") == 0;
+
+        harness_isolate();
+
+        if(harness_perf_fd == -1) {
+                harness_counters_open();
+        }
+
+        harness_counter_valid = 0;
+        harness_switched = 0;
+
+#ifdef BENCH_LATENCY
+        h->op_overhead = harness_op_overhead();
+#endif
+}
+
+
+/* adds one sample, picking up counters if the kernel used harness_stop */
+static void
+harness_sample(struct harness *h, double value) {
+        int outlier = harness_switched && !h->keep_outliers;
+
+#ifdef BENCH_LATENCY
+        /* context switches are part of the tail, so every run is kept */
+        if(harness_hist_count && h->latency_count < BENCH_SAMPLES) {
+                int i;
+                for(i = 0; i < HARNESS_PCT_COUNT; ++i) {
+                        h->latency[i][h->latency_count] =
+                                (double)harness_hist_percentile(harness_pcts[i]);
+                }
+                h->latency_count += 1;
+        }
+        harness_hist_clear();
+#endif
+
+        if(h->count + h->outlier_count == BENCH_SAMPLES) {
+                return;
+        }
+
+        if(outlier) {
+                if(harness_counter_valid) {
+                        memcpy(h->outlier_counters[h->outlier_counter_count++],
+                                harness_counter_values,
+                                sizeof(harness_counter_values));
+                        harness_counter_valid = 0;
+                }
+
+                h->outliers[h->outlier_count++] = value;
+                return;
+        }
+
+        if(harness_counter_valid) {
+                memcpy(h->counters[h->counter_count++], harness_counter_values,
+                        sizeof(harness_counter_values));
+                harness_counter_valid = 0;
+        }
+
+        h->samples[h->count++] = value;
+}
+
+
+static int
+harness_cmp_double(const void *a, const void *b) {
+        double x = *(const double*)a;
+        double y = *(const double*)b;
+        return (x > y) - (x < y);
+}
+
+
+static int
+harness_cmp_u64(const void *a, const void *b) {
+        uint64_t x = *(const uint64_t*)a;
+        uint64_t y = *(const uint64_t*)b;
+        return (x > y) - (x < y);
+}
+
+
+static double
+harness_median(double *sorted, int count) {
+        if(count == 0) {
+                return 0.0;
+        }
+
+        if(count & 1) {
+                return sorted[count / 2];
+        }
+
+        return (sorted[count / 2 - 1] + sorted[count / 2]) * 0.5;
+}
+
+
+static void
+harness_stats(struct harness *h) {
+        double sorted[BENCH_SAMPLES];
+        double sum = 0.0, sq = 0.0;
+        int i;
+
+        /* a noisy box is better reported than dropped */
+        if(h->count == 0 && h->outlier_count) {
+                memcpy(h->samples, h->outliers, h->outlier_count * sizeof(double));
+                memcpy(h->counters, h->outlier_counters,
+                        sizeof(h->outlier_counters));
+                h->count = h->outlier_count;
+                h->counter_count = h->outlier_counter_count;
+                h->outlier_count = 0;
+        }
+
+        if(h->count == 0) {
+                return;
+        }
+
+        memcpy(sorted, h->samples, h->count * sizeof(double));
+        qsort(sorted, h->count, sizeof(double), harness_cmp_double);
+
+        for(i = 0; i < h->count; ++i) {
+                sum += sorted[i];
+        }
+        h->mean = sum / h->count;
+
+        for(i = 0; i < h->count; ++i) {
+                sq += (sorted[i] - h->mean) * (sorted[i] - h->mean);
+        }
+        /* sqrtsd directly, so nothing needs -lm */
+        if(h->count > 1) {
+                h->stddev = _mm_cvtsd_f64(_mm_sqrt_sd(_mm_setzero_pd(),
+                        _mm_set_sd(sq / (h->count - 1))));
+        }
+
+        h->min = sorted[0];
+        h->max = sorted[h->count - 1];
+        h->median = harness_median(sorted, h->count);
+}
+
+
+static uint64_t
+harness_counter_median(struct harness *h, int counter) {
+        uint64_t values[BENCH_SAMPLES];
+        int i;
+
+        for(i = 0; i < h->counter_count; ++i) {
+                values[i] = h->counters[i][counter];
+        }
+
+        qsort(values, h->counter_count, sizeof(uint64_t), harness_cmp_u64);
+
+        return values[h->counter_count / 2];
+}
+
+
+/* output */
+static void
+harness_json_str(FILE *out, const char *key, const char *value) {
+        fprintf(out, "\"%s\":\"", key);
+        while(*value) {
+                if(*value == '"' || *value == '\\') {
+                        fputc('\\', out);
+                }
+                fputc(*value >= ' ' ? *value : ' ', out);
+                ++value;
+        }
+        fputs("\",", out);
+}
+
+
+static void
+harness_write_json(FILE *out, struct harness *h) {
+        int i;
+
+        fputc('{', out);
+        harness_json_str(out, "suite", h->suite);
+        harness_json_str(out, "variant", h->variant);
+        harness_json_str(out, "inputs", h->inputs);
+        harness_json_str(out, "unit", h->unit);
+        harness_json_str(out, "better", h->lower_is_better ? "lower" : "higher");
+        harness_json_str(out, "compiler", HARNESS_COMPILER);
+        harness_json_str(out, "flags", BENCH_FLAGS);
+        harness_json_str(out, "cpu", harness_cpu());
+        harness_json_str(out, "host", harness_host());
+
+        fprintf(out, "\"count\":%d,\"min\":%.17g,\"median\":%.17g,"
+                "\"mean\":%.17g,\"stddev\":%.17g,\"max\":%.17g,"
+                "\"outliers\":%d,", h->count, h->min, h->median, h->mean,
+                h->stddev, h->max, h->outlier_count);
+
+        fputs("\"counters\":", out);
+        if(h->counter_count) {
+                fputc('{', out);
+                for(i = 0; i < HARNESS_COUNTER_COUNT; ++i) {
+                        fprintf(out, "%s\"%s\":%llu", i ? "," : "",
+                                harness_counter_names[i],
+                                (unsigned long long)harness_counter_median(h, i));
+                }
+                fputc('}', out);
+        } else {
+                fputs("null", out);
+        }
+
+        fputs(",\"samples\":[", out);
+        for(i = 0; i < h->count; ++i) {
+                fprintf(out, "%s%.17g", i ? "," : "", h->samples[i]);
+        }
+        fputs("]}\n", out);
+}
+
+
+static void
+harness_csv_str(FILE *out, const char *value) {
+        fputc('"', out);
+        while(*value) {
+                if(*value == '"') {
+                        fputc('"', out);
+                }
+                fputc(*value, out);
+                ++value;
+        }
+        fputs("\",", out);
+}
+
+
+static void
+harness_write_csv(FILE *out, struct harness *h, int header) {
+        int i;
+
+        if(header) {
+                fputs("suite,variant,inputs,unit,better,compiler,flags,cpu,"
+                        "host,count,min,median,mean,stddev,max,outliers", out);
+                for(i = 0; i < HARNESS_COUNTER_COUNT; ++i) {
+                        fprintf(out, ",%s", harness_counter_names[i]);
+                }
+                fputs(",samples\n", out);
+        }
+
+        harness_csv_str(out, h->suite);
+        harness_csv_str(out, h->variant);
+        harness_csv_str(out, h->inputs);
+        harness_csv_str(out, h->unit);
+        harness_csv_str(out, h->lower_is_better ? "lower" : "higher");
+        harness_csv_str(out, HARNESS_COMPILER);
+        harness_csv_str(out, BENCH_FLAGS);
+        harness_csv_str(out, harness_cpu());
+        harness_csv_str(out, harness_host());
+
+        fprintf(out, "%d,%.17g,%.17g,%.17g,%.17g,%.17g,%d", h->count, h->min,
+                h->median, h->mean, h->stddev, h->max, h->outlier_count);
+
+        for(i = 0; i < HARNESS_COUNTER_COUNT; ++i) {
+                if(h->counter_count) {
+                        fprintf(out, ",%llu", (unsigned long long)
+                                harness_counter_median(h, i));
+                } else {
+                        fputc(',', out);
+                }
+        }
+
+        /* samples are space separated so the column count stays fixed */
+        fputs(",\"", out);
+        for(i = 0; i < h->count; ++i) {
+                fprintf(out, "%s%.17g", i ? " " : "", h->samples[i]);
+        }
+        fputs("\"\n", out);
+}
+
+
+/* writes one record */
+static void
+harness_write(struct harness *h) {
+        const char *path = getenv("BENCH_RESULTS");
+        const char *format = getenv("BENCH_FORMAT");
+        int csv = format && strcmp(format, "csv") == 0;
+        static int stdout_header = 0;
+        FILE *out = stdout;
+        int header = csv && !stdout_header;
+
+        if(path && path[0]) {
+                out = fopen(path, "a");
+                if(!out) {
+                        fprintf(stderr, "Can't open %s\n", path);
+                        return;
+                }
+
+                /* only the first record in a CSV file gets the header */
+                fseek(out, 0, SEEK_END);
+                header = csv && ftell(out) == 0;
+        } else if(csv) {
+                stdout_header = 1;
+        }
+
+        if(csv) {
+                harness_write_csv(out, h, header);
+        } else {
+                harness_write_json(out, h);
+        }
+
+        if(out != stdout) {
+                fclose(out);
+        }
+}
+
+/* works out the stats and writes the record, and the latency ones */
+static void
+harness_report(struct harness *h) {
+        harness_stats(h);
+        harness_write(h);
+
+#ifdef BENCH_LATENCY
+        struct harness l;
+        char unit[32];
+        int i;
+
+        if(!h->latency_count) {
+                return;
+        }
+
+        for(i = 0; i <= HARNESS_PCT_COUNT; ++i) {
+                memset(&l, 0, sizeof(l));
+                l.suite = h->suite;
+                l.variant = h->variant;
+                l.inputs = h->inputs;
+                l.unit = unit;
+                l.lower_is_better = 1;
+
+                if(i < HARNESS_PCT_COUNT) {
+                        snprintf(unit, sizeof(unit), "cycles/%s %s",
+                                BENCH_LATENCY_BATCH > 1 ? "batch" : "op",
+                                harness_pct_names[i]);
+                        memcpy(l.samples, h->latency[i],
+                                h->latency_count * sizeof(double));
+                        l.count = h->latency_count;
+                } else {
+                        snprintf(unit, sizeof(unit), "cycles/op timer");
+                        l.samples[0] = h->op_overhead;
+                        l.count = 1;
+                }
+
+                harness_stats(&l);
+                harness_write(&l);
+        }
+#endif
+}
+
+#endif
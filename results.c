@@ -0,0 +1,869 @@
+/*
+ * Benchmark Results Tool
+ * ======================
+ *
+ * Reads the records written by harness.h (JSON lines or CSV).
+ *
+ * gcc results.c -O2 -lm -o results
+ *
+ * Compare
+ * -------
+ *
+ * results compare [options] base.jsonl new.jsonl
+ *
+ * Matches records by suite, variant, inputs, unit, compiler and flags and
+ * checks if the new samples differ from the base ones.
+ *
+ * - Mann-Whitney U test (normal approximation, tie corrected) for p
+ * - Bootstrap 95% confidence interval of the ratio of medians
+ * - A change is only flagged when p < alpha, the interval doesn't cover
+ *   1.0 and the medians moved by more than the threshold
+ * - Exits with 1 if any record regressed, so it can gate a build
+ *
+ * Options
+ *
+ * -t <percent>    threshold, default 5
+ * -a <alpha>      significance level, default 0.05
+ * -b              ignore compiler and flags when matching, for comparing
+ *                 one toolchain against another
+ *
+ * Table
+ * -----
+ *
+ * results table results.jsonl [more.jsonl ..]
+ *
+ * Prints the results as the ASCII tables used in the bench_*.c headers.
+ * One table per suite and unit, a column per variant, a row per compiler,
+ * flags and inputs. Cells are the best sample (fastest run).
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <ctype.h>
+#include <math.h>
+
+#define MAX_SAMPLES 4096
+#define MAX_FIELD 256
+#define BOOTSTRAP_ROUNDS 2000
+
+
+struct record {
+        char suite[MAX_FIELD];
+        char variant[MAX_FIELD];
+        char inputs[MAX_FIELD];
+        char unit[MAX_FIELD];
+        char compiler[MAX_FIELD];
+        char flags[MAX_FIELD];
+        char cpu[MAX_FIELD];
+        char host[MAX_FIELD];
+        int lower_is_better;
+
+        double *samples;
+        int count;
+};
+
+struct record_list {
+        struct record *records;
+        int count;
+        int capacity;
+};
+
+
+/* xorshift, bootstrap is the same every run */
+uint64_t rand_state = 0x2545F4914F6CDD1Dull;
+
+uint64_t
+rand_next() {
+        rand_state ^= rand_state << 13;
+        rand_state ^= rand_state >> 7;
+        rand_state ^= rand_state << 17;
+        return rand_state;
+}
+
+
+/* record fields */
+void
+record_set(struct record *r, const char *key, const char *value) {
+        char *dst = 0;
+
+        if(strcmp(key, "suite") == 0) { dst = r->suite; }
+        else if(strcmp(key, "variant") == 0) { dst = r->variant; }
+        else if(strcmp(key, "inputs") == 0) { dst = r->inputs; }
+        else if(strcmp(key, "unit") == 0) { dst = r->unit; }
+        else if(strcmp(key, "compiler") == 0) { dst = r->compiler; }
+        else if(strcmp(key, "flags") == 0) { dst = r->flags; }
+        else if(strcmp(key, "cpu") == 0) { dst = r->cpu; }
+        else if(strcmp(key, "host") == 0) { dst = r->host; }
+        else if(strcmp(key, "better") == 0) {
+                r->lower_is_better = strcmp(value, "higher") != 0;
+        }
+
+        if(dst) {
+                strncpy(dst, value, MAX_FIELD - 1);
+                dst[MAX_FIELD - 1] = 0;
+        }
+}
+
+
+void
+record_add_sample(struct record *r, double value) {
+        if(!r->samples) {
+                r->samples = malloc(MAX_SAMPLES * sizeof(double));
+        }
+
+        if(r->count < MAX_SAMPLES) {
+                r->samples[r->count++] = value;
+        }
+}
+
+
+/* JSON */
+/* only what harness.h writes, a flat object with one nested counters
+   object and a samples array of numbers */
+const char *
+json_ws(const char *p) {
+        while(*p && isspace((unsigned char)*p)) {
+                ++p;
+        }
+        return p;
+}
+
+
+const char *
+json_string(const char *p, char *out, int out_size) {
+        int len = 0;
+
+        if(*p != '"') {
+                return 0;
+        }
+        ++p;
+
+        while(*p && *p != '"') {
+                char c = *p++;
+                if(c == '\\' && *p) {
+                        c = *p++;
+                }
+                if(len < out_size - 1) {
+                        out[len++] = c;
+                }
+        }
+        out[len] = 0;
+
+        return *p == '"' ? p + 1 : 0;
+}
+
+
+/* skips a number, null, or a nested object / array */
+const char *
+json_skip(const char *p) {
+        char tmp[MAX_FIELD];
+        int depth = 0;
+
+        do {
+                p = json_ws(p);
+                if(*p == '"') {
+                        p = json_string(p, tmp, sizeof(tmp));
+                        if(!p) {
+                                return 0;
+                        }
+                        continue;
+                }
+                if(*p == '{' || *p == '[') {
+                        ++depth;
+                } else if(*p == '}' || *p == ']') {
+                        --depth;
+                } else if(!*p) {
+                        return 0;
+                } else if(depth == 0 && (*p == ',')) {
+                        return p;
+                }
+                ++p;
+        } while(depth > 0 || (*p != ',' && *p != '}'));
+
+        return p;
+}
+
+
+int
+parse_json(const char *line, struct record *r) {
+        char key[MAX_FIELD];
+        char value[MAX_FIELD];
+        const char *p = json_ws(line);
+
+        if(*p++ != '{') {
+                return 0;
+        }
+
+        while(1) {
+                p = json_ws(p);
+                if(*p == '}') {
+                        return 1;
+                }
+
+                p = json_string(p, key, sizeof(key));
+                if(!p) {
+                        return 0;
+                }
+
+                p = json_ws(p);
+                if(*p++ != ':') {
+                        return 0;
+                }
+                p = json_ws(p);
+
+                if(*p == '"') {
+                        p = json_string(p, value, sizeof(value));
+                        if(!p) {
+                                return 0;
+                        }
+                        record_set(r, key, value);
+                } else if(strcmp(key, "samples") == 0 && *p == '[') {
+                        ++p;
+                        while(1) {
+                                char *end;
+                                p = json_ws(p);
+                                if(*p == ']') {
+                                        ++p;
+                                        break;
+                                }
+                                double v = strtod(p, &end);
+                                if(end == p) {
+                                        return 0;
+                                }
+                                record_add_sample(r, v);
+                                p = json_ws(end);
+                                if(*p == ',') {
+                                        ++p;
+                                }
+                        }
+                } else {
+                        p = json_skip(p);
+                        if(!p) {
+                                return 0;
+                        }
+                }
+
+                p = json_ws(p);
+                if(*p == ',') {
+                        ++p;
+                }
+        }
+}
+
+
+/* CSV */
+/* splits one line into fields, handles "quoted, fields" and "" */
+int
+csv_split(const char *line, char fields[][MAX_FIELD * 64], int max_fields) {
+        int count = 0;
+
+        while(count < max_fields) {
+                char *out = fields[count];
+                int len = 0;
+
+                if(*line == '"') {
+                        ++line;
+                        while(*line) {
+                                if(*line == '"' && line[1] == '"') {
+                                        line += 2;
+                                        out[len++] = '"';
+                                } else if(*line == '"') {
+                                        ++line;
+                                        break;
+                                } else {
+                                        out[len++] = *line++;
+                                }
+                                if(len == MAX_FIELD * 64 - 1) {
+                                        break;
+                                }
+                        }
+                }
+
+                while(*line && *line != ',' && *line != '\n' && *line != '\r') {
+                        if(len < MAX_FIELD * 64 - 1) {
+                                out[len++] = *line;
+                        }
+                        ++line;
+                }
+
+                out[len] = 0;
+                ++count;
+
+                if(*line != ',') {
+                        break;
+                }
+                ++line;
+        }
+
+        return count;
+}
+
+
+#define CSV_MAX_COLUMNS 32
+
+/* returns the number of records read */
+int
+read_file(const char *path, struct record_list *list) {
+        static char header[CSV_MAX_COLUMNS][MAX_FIELD * 64];
+        static char fields[CSV_MAX_COLUMNS][MAX_FIELD * 64];
+        static char line[1 << 20];
+        int header_count = 0;
+        int read = 0;
+        FILE *f = fopen(path, "r");
+
+        if(!f) {
+                fprintf(stderr, "Can't open %s\n", path);
+                exit(2);
+        }
+
+        while(fgets(line, sizeof(line), f)) {
+                struct record r;
+                memset(&r, 0, sizeof(r));
+                r.lower_is_better = 1;
+
+                if(line[0] == '{') {
+                        if(!parse_json(line, &r)) {
+                                fprintf(stderr, "Bad record in %s\n", path);
+                                free(r.samples);
+                                continue;
+                        }
+                } else if(strncmp(line, "suite,", 6) == 0) {
+                        header_count = csv_split(line, header, CSV_MAX_COLUMNS);
+                        continue;
+                } else if(header_count && line[0] == '"') {
+                        int n = csv_split(line, fields, CSV_MAX_COLUMNS);
+                        int i;
+
+                        for(i = 0; i < n && i < header_count; ++i) {
+                                if(strcmp(header[i], "samples") == 0) {
+                                        char *p = fields[i];
+                                        char *end;
+                                        while(1) {
+                                                double v = strtod(p, &end);
+                                                if(end == p) {
+                                                        break;
+                                                }
+                                                record_add_sample(&r, v);
+                                                p = end;
+                                        }
+                                } else {
+                                        record_set(&r, header[i], fields[i]);
+                                }
+                        }
+                } else {
+                        /* benchmark output mixed in on stdout */
+                        continue;
+                }
+
+                if(!r.count) {
+                        free(r.samples);
+                        continue;
+                }
+
+                if(list->count == list->capacity) {
+                        list->capacity = list->capacity ? list->capacity * 2 : 64;
+                        list->records = realloc(list->records,
+                                list->capacity * sizeof(struct record));
+                }
+
+                list->records[list->count++] = r;
+                ++read;
+        }
+
+        fclose(f);
+
+        return read;
+}
+
+
+/* stats */
+int
+cmp_double(const void *a, const void *b) {
+        double x = *(const double*)a;
+        double y = *(const double*)b;
+        return (x > y) - (x < y);
+}
+
+
+double
+median(const double *values, int count) {
+        double *sorted = malloc(count * sizeof(double));
+        double m;
+
+        memcpy(sorted, values, count * sizeof(double));
+        qsort(sorted, count, sizeof(double), cmp_double);
+
+        if(count & 1) {
+                m = sorted[count / 2];
+        } else {
+                m = (sorted[count / 2 - 1] + sorted[count / 2]) * 0.5;
+        }
+
+        free(sorted);
+
+        return m;
+}
+
+
+/* two sided p value that a and b come from the same distribution */
+struct ranked {
+        double value;
+        int group;
+};
+
+int
+cmp_ranked(const void *a, const void *b) {
+        return cmp_double(&((const struct ranked*)a)->value,
+                &((const struct ranked*)b)->value);
+}
+
+
+double
+mann_whitney_p(const double *a, int na, const double *b, int nb) {
+        int n = na + nb;
+        struct ranked *all = malloc(n * sizeof(struct ranked));
+        double rank_sum_a = 0.0;
+        double tie_sum = 0.0;
+        int i, j;
+
+        for(i = 0; i < na; ++i) {
+                all[i].value = a[i];
+                all[i].group = 0;
+        }
+        for(i = 0; i < nb; ++i) {
+                all[na + i].value = b[i];
+                all[na + i].group = 1;
+        }
+
+        qsort(all, n, sizeof(struct ranked), cmp_ranked);
+
+        /* ties share the average of their ranks */
+        for(i = 0; i < n; i = j) {
+                j = i;
+                while(j < n && all[j].value == all[i].value) {
+                        ++j;
+                }
+
+                double rank = (i + 1 + j) * 0.5;
+                double t = j - i;
+                int k;
+
+                for(k = i; k < j; ++k) {
+                        if(all[k].group == 0) {
+                                rank_sum_a += rank;
+                        }
+                }
+                tie_sum += t * t * t - t;
+        }
+
+        free(all);
+
+        double u = rank_sum_a - na * (na + 1) * 0.5;
+        double mu = na * nb * 0.5;
+        double var = na * nb / 12.0 *
+                ((n + 1) - tie_sum / ((double)n * (n - 1)));
+
+        if(var <= 0.0) {
+                return 1.0;
+        }
+
+        double diff = fabs(u - mu) - 0.5;
+        if(diff < 0.0) {
+                diff = 0.0;
+        }
+
+        return erfc(diff / sqrt(var) / sqrt(2.0));
+}
+
+
+/* 95% interval of median(b) / median(a) */
+void
+bootstrap_ratio(
+        const double *a, int na,
+        const double *b, int nb,
+        double *lo, double *hi)
+{
+        double *ratios = malloc(BOOTSTRAP_ROUNDS * sizeof(double));
+        double *ra = malloc(na * sizeof(double));
+        double *rb = malloc(nb * sizeof(double));
+        int round, i;
+
+        for(round = 0; round < BOOTSTRAP_ROUNDS; ++round) {
+                for(i = 0; i < na; ++i) {
+                        ra[i] = a[rand_next() % na];
+                }
+                for(i = 0; i < nb; ++i) {
+                        rb[i] = b[rand_next() % nb];
+                }
+
+                double ma = median(ra, na);
+                ratios[round] = ma != 0.0 ? median(rb, nb) / ma : 1.0;
+        }
+
+        qsort(ratios, BOOTSTRAP_ROUNDS, sizeof(double), cmp_double);
+        *lo = ratios[(int)(BOOTSTRAP_ROUNDS * 0.025)];
+        *hi = ratios[(int)(BOOTSTRAP_ROUNDS * 0.975)];
+
+        free(ratios);
+        free(ra);
+        free(rb);
+}
+
+
+/* compare */
+int
+same_record(const struct record *a, const struct record *b, int ignore_build) {
+        if(strcmp(a->suite, b->suite) || strcmp(a->variant, b->variant) ||
+           strcmp(a->inputs, b->inputs) || strcmp(a->unit, b->unit)) {
+                return 0;
+        }
+
+        if(!ignore_build && (strcmp(a->compiler, b->compiler) ||
+           strcmp(a->flags, b->flags))) {
+                return 0;
+        }
+
+        return 1;
+}
+
+
+/* the last record for a key wins, so appending a rerun replaces it */
+const struct record *
+find_record(
+        const struct record_list *list,
+        const struct record *key,
+        int ignore_build)
+{
+        int i;
+
+        for(i = list->count - 1; i >= 0; --i) {
+                if(same_record(&list->records[i], key, ignore_build)) {
+                        return &list->records[i];
+                }
+        }
+
+        return 0;
+}
+
+
+int
+compare(int argc, char **argv) {
+        struct record_list base = {0};
+        struct record_list next = {0};
+        double threshold = 5.0;
+        double alpha = 0.05;
+        int ignore_build = 0;
+        int regressions = 0, improvements = 0, matched = 0;
+        int width = (int)strlen("suite/variant/inputs/unit");
+        int i;
+
+        if(argc < 2) {
+                fprintf(stderr, "results compare [-t pct] [-a alpha] [-b] "
+                        "base new\n");
+                return 2;
+        }
+
+        for(i = 0; i < argc - 2; ++i) {
+                if(strcmp(argv[i], "-t") == 0 && i + 1 < argc - 2) {
+                        threshold = atof(argv[++i]);
+                } else if(strcmp(argv[i], "-a") == 0 && i + 1 < argc - 2) {
+                        alpha = atof(argv[++i]);
+                } else if(strcmp(argv[i], "-b") == 0) {
+                        ignore_build = 1;
+                } else {
+                        fprintf(stderr, "Unknown option %s\n", argv[i]);
+                        return 2;
+                }
+        }
+
+        read_file(argv[argc - 2], &base);
+        read_file(argv[argc - 1], &next);
+
+        /* name column fits the longest name so none are cut short */
+        for(i = 0; i < next.count; ++i) {
+                const struct record *n = &next.records[i];
+                int len = (int)(strlen(n->suite) + strlen(n->variant) +
+                        strlen(n->inputs) + strlen(n->unit) + 3);
+                if(len > width) {
+                        width = len;
+                }
+        }
+
+        printf(" %-*s | %12s | %12s | %8s | %17s | %6s |\n", width,
+                "suite/variant/inputs/unit", "base", "new", "change",
+                "95% CI", "p");
+        for(i = 0; i < width + 2; ++i) {
+                putchar('=');
+        }
+        printf("|==============|==============|==========|"
+                "===================|========|=========\n");
+
+        for(i = 0; i < next.count; ++i) {
+                const struct record *n = &next.records[i];
+                const struct record *b = find_record(&base, n, ignore_build);
+                char name[MAX_FIELD * 4];
+                const char *verdict = "";
+
+                /* only report the last record for each key */
+                if(find_record(&next, n, ignore_build) != n) {
+                        continue;
+                }
+
+                if(!b) {
+                        continue;
+                }
+
+                ++matched;
+
+                double mb = median(b->samples, b->count);
+                double mn = median(n->samples, n->count);
+                double change = mb != 0.0 ? (mn / mb - 1.0) * 100.0 : 0.0;
+                double p = mann_whitney_p(b->samples, b->count, n->samples,
+                        n->count);
+                double lo, hi;
+
+                bootstrap_ratio(b->samples, b->count, n->samples, n->count,
+                        &lo, &hi);
+
+                int significant = p < alpha && fabs(change) > threshold &&
+                        (lo > 1.0 || hi < 1.0);
+                int worse = n->lower_is_better ? change > 0.0 : change < 0.0;
+
+                if(significant && worse) {
+                        verdict = "REGRESSED";
+                        ++regressions;
+                } else if(significant) {
+                        verdict = "improved";
+                        ++improvements;
+                }
+
+                snprintf(name, sizeof(name), "%s/%s/%s/%s", n->suite,
+                        n->variant, n->inputs, n->unit);
+
+                printf(" %-*s | %12.6g | %12.6g | %+7.1f%% | "
+                        "[%6.3f, %6.3f] | %6.4f | %s\n",
+                        width, name, mb, mn, change, lo, hi, p, verdict);
+        }
+
+        printf("\n%d matched, %d regressed, %d improved "
+                "(threshold %.1f%%, alpha %.3f)\n",
+                matched, regressions, improvements, threshold, alpha);
+
+        return regressions ? 1 : 0;
+}
+
+
+/* table */
+#define TABLE_MAX 256
+#define CELL_SIZE 64
+/* a row is a platform number and three fields */
+#define KEY_SIZE (MAX_FIELD * 4)
+
+/* cpu (host) of each platform, rows are numbered after these */
+char platforms[TABLE_MAX][KEY_SIZE];
+int platform_count = 0;
+
+/* adds str to list if it isn't there, returns its index */
+int
+intern(char list[][KEY_SIZE], int *count, const char *str) {
+        int i;
+
+        for(i = 0; i < *count; ++i) {
+                if(strcmp(list[i], str) == 0) {
+                        return i;
+                }
+        }
+
+        if(*count == TABLE_MAX) {
+                return -1;
+        }
+
+        strncpy(list[*count], str, KEY_SIZE - 1);
+        return (*count)++;
+}
+
+
+void
+format_value(char *out, double v) {
+        if(v >= 1000.0 || v == (double)(int64_t)v) {
+                snprintf(out, CELL_SIZE, "%.0f", v);
+        } else {
+                snprintf(out, CELL_SIZE, "%.3g", v);
+        }
+}
+
+
+double
+best_sample(const struct record *r) {
+        double best = r->samples[0];
+        int i;
+
+        for(i = 1; i < r->count; ++i) {
+                if(r->lower_is_better ? r->samples[i] < best :
+                   r->samples[i] > best) {
+                        best = r->samples[i];
+                }
+        }
+
+        return best;
+}
+
+
+void
+print_rule(int *widths, int columns, char fill) {
+        int c, i;
+
+        for(c = 0; c < columns; ++c) {
+                for(i = 0; i < widths[c] + 2; ++i) {
+                        putchar(fill);
+                }
+                putchar(c == columns - 1 ? '\n' : '|');
+        }
+}
+
+
+void
+print_table(const struct record_list *list, const char *suite, const char *unit) {
+        static char variants[TABLE_MAX][KEY_SIZE];
+        static char rows[TABLE_MAX][KEY_SIZE];
+        static char cells[TABLE_MAX][TABLE_MAX][CELL_SIZE];
+        int variant_count = 0, row_count = 0;
+        int lower_is_better = 1;
+        int widths[TABLE_MAX + 1];
+        int i, r, v;
+
+        memset(cells, 0, sizeof(cells));
+
+        for(i = 0; i < list->count; ++i) {
+                const struct record *rec = &list->records[i];
+                char row[KEY_SIZE];
+
+                if(strcmp(rec->suite, suite) || strcmp(rec->unit, unit)) {
+                        continue;
+                }
+
+                /* same build on two machines is two rows */
+                snprintf(row, sizeof(row), "%s (%s)", rec->cpu, rec->host);
+                int platform = intern(platforms, &platform_count, row);
+
+                snprintf(row, sizeof(row), "%d(%s %s) | %s", platform + 1,
+                        rec->compiler, rec->flags, rec->inputs);
+
+                v = intern(variants, &variant_count, rec->variant);
+                r = intern(rows, &row_count, row);
+                if(v < 0 || r < 0) {
+                        continue;
+                }
+
+                lower_is_better = rec->lower_is_better;
+                format_value(cells[r][v], best_sample(rec));
+        }
+
+        /* first column is platform | inputs, already split by " | " */
+        widths[0] = (int)strlen("Platform | Inputs");
+        for(r = 0; r < row_count; ++r) {
+                int len = (int)strlen(rows[r]);
+                if(len > widths[0]) {
+                        widths[0] = len;
+                }
+        }
+
+        for(v = 0; v < variant_count; ++v) {
+                widths[v + 1] = (int)strlen(variants[v]);
+                for(r = 0; r < row_count; ++r) {
+                        int len = (int)strlen(cells[r][v]);
+                        if(len > widths[v + 1]) {
+                                widths[v + 1] = len;
+                        }
+                }
+        }
+
+        printf("%s (%s)\n", suite, unit);
+        for(i = 0; i < (int)(strlen(suite) + strlen(unit) + 3); ++i) {
+                putchar('-');
+        }
+        printf("\n\n_Note:_ Best sample, %s is better\n\n",
+                lower_is_better ? "lower" : "higher");
+
+        printf(" %-*s ", widths[0], "Platform | Inputs");
+        for(v = 0; v < variant_count; ++v) {
+                printf("| %-*s ", widths[v + 1], variants[v]);
+        }
+        printf("\n");
+        print_rule(widths, variant_count + 1, '=');
+
+        for(r = 0; r < row_count; ++r) {
+                printf(" %-*s ", widths[0], rows[r]);
+                for(v = 0; v < variant_count; ++v) {
+                        printf("| %-*s ", widths[v + 1], cells[r][v]);
+                }
+                printf("\n");
+        }
+
+        printf("\n");
+}
+
+
+int
+table(int argc, char **argv) {
+        static char tables[TABLE_MAX][KEY_SIZE];
+        struct record_list list = {0};
+        int table_count = 0;
+        int i;
+
+        if(argc < 1) {
+                fprintf(stderr, "results table file [file ..]\n");
+                return 2;
+        }
+
+        for(i = 0; i < argc; ++i) {
+                read_file(argv[i], &list);
+        }
+
+        for(i = 0; i < list.count; ++i) {
+                char key[KEY_SIZE];
+
+                snprintf(key, sizeof(key), "%s (%s)", list.records[i].cpu,
+                        list.records[i].host);
+                intern(platforms, &platform_count, key);
+
+                /* suite and unit, unit can't have a tab in it */
+                snprintf(key, sizeof(key), "%s\t%s", list.records[i].suite,
+                        list.records[i].unit);
+                intern(tables, &table_count, key);
+        }
+
+        printf("Platforms\n---------\n\n");
+        for(i = 0; i < platform_count; ++i) {
+                printf("%d. %s\n", i + 1, platforms[i]);
+        }
+        printf("\n");
+
+        for(i = 0; i < table_count; ++i) {
+                char *tab = strchr(tables[i], '\t');
+                *tab = 0;
+                print_table(&list, tables[i], tab + 1);
+        }
+
+        return 0;
+}
+
+
+/* Tool */
+int
+main(int argc, char **argv) {
+        if(argc > 1 && strcmp(argv[1], "compare") == 0) {
+                return compare(argc - 2, argv + 2);
+        }
+
+        if(argc > 1 && strcmp(argv[1], "table") == 0) {
+                return table(argc - 2, argv + 2);
+        }
+
+        fprintf(stderr, "results compare [-t pct] [-a alpha] [-b] base new\n");
+        fprintf(stderr, "results table file [file ..]\n");
+
+        return 2;
+}